@@ -4,17 +4,14 @@
 #include "compiler/Parser.hpp"
 #include "compiler/Compiler.hpp"
 #include "execution/Machine.hpp"
+#include "execution/CppTranslator.hpp"
 #include "compiler/Validator.hpp"
 
 #include "standard/MachineFunctions.hpp"
 
-void test1(GobLang::Machine *machine)
+void test1(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
-    GobLang::MemoryValue *b = machine->getStackTopAndPop();
-    GobLang::MemoryValue *a = machine->getStackTopAndPop();
-    std::cout << "A: " << std::get<int32_t>(a->value) << " B: " << std::get<int32_t>(b->value) << std::endl;
-    delete a;
-    delete b;
+    std::cout << "A: " << args.getInt(0) << " B: " << args.getInt(1) << std::endl;
 }
 
 void byteCodeToText(std::vector<uint8_t> const &bytecode)
@@ -32,8 +29,14 @@ void byteCodeToText(std::vector<uint8_t> const &bytecode)
         if (opIt != GobLang::Operations.end())
         {
             std::cout << std::hex << address << std::dec << ": " << (opIt->text) << " ";
-            if (opIt->argCount == sizeof(GobLang::ProgramAddressType))
+            if (opIt->isJump)
             {
+                for (int32_t i = 0; i < opIt->argCount - (int32_t)sizeof(GobLang::ProgramAddressType); i++)
+                {
+                    it++;
+                    address += 1;
+                    std::cout << std::to_string(*it) << " ";
+                }
                 size_t reconAddr = 0x0;
                 for (int32_t i = 0; i < sizeof(GobLang::ProgramAddressType); i++)
                 {
@@ -51,7 +54,7 @@ void byteCodeToText(std::vector<uint8_t> const &bytecode)
                 {
                     it++;
                     address += 1;
-                    std::cout << std::to_string(*it);
+                    std::cout << std::to_string(*it) << " ";
                 }
             }
             address++;
@@ -59,9 +62,28 @@ void byteCodeToText(std::vector<uint8_t> const &bytecode)
         }
     }
 }
-int main()
+int main(int argc, char **argv)
 {
     std::string file = "./code.gob";
+    // when set, byte code is translated into C++ source instead of being executed
+    std::string cppFile;
+    bool registerBased = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if ((arg == "-i" || arg == "--input") && i + 1 < argc)
+        {
+            file = argv[++i];
+        }
+        else if (arg == "--emit-cpp" && i + 1 < argc)
+        {
+            cppFile = argv[++i];
+        }
+        else if (arg == "-r" || arg == "--registers")
+        {
+            registerBased = true;
+        }
+    }
     std::vector<std::string> lines;
     std::ifstream codeFile(file);
     if (!codeFile.is_open())
@@ -76,40 +98,32 @@ int main()
     }
 
     GobLang::Compiler::Parser comp(lines);
-    int a = 3;
-    bool b = !(a < 3 || (a > 1 && !(a < 1)));
-    std::cout << (b ? "true" : "false") << std::endl;
     comp.parse();
-    comp.printCode();
     GobLang::Compiler::Validator validator(comp);
     validator.validate();
-    GobLang::Compiler::Compiler compiler(comp);
+    GobLang::NativeRegistry natives;
+    MachineFunctions::addStandardFunctions(natives);
+    GobLang::Compiler::Compiler compiler(comp, registerBased, &natives);
     compiler.compile();
-    compiler.printCode();
     compiler.generateByteCode();
-    byteCodeToText(compiler.getByteCode().operations);
-
-    GobLang::Machine machine(compiler.getByteCode());
-    machine.addFunction(MachineFunctions::getSizeof, "sizeof");
-    machine.addFunction(MachineFunctions::printLine, "print_line");
-    machine.addFunction(MachineFunctions::print, "print");
-    machine.addFunction(MachineFunctions::createArrayOfSize, "array");
-    machine.addFunction(MachineFunctions::input, "input");
-    machine.addFunction(MachineFunctions::Math::toInt, "to_int");
-    machine.addFunction(MachineFunctions::Math::randomIntInRange, "rand_range");
-    machine.addFunction(MachineFunctions::Math::randomInt, "rand");
-    std::vector<size_t> debugPoints = {};
-    while (!machine.isAtTheEnd())
+    if (!cppFile.empty())
     {
-        if (std::find(debugPoints.begin(), debugPoints.end(), machine.getProgramCounter()) != debugPoints.end())
+        std::ofstream out(cppFile);
+        if (!out.is_open())
         {
-            std::cout << "Debugging at " << std::hex << machine.getProgramCounter() << std::dec << ". Memory state: " << std::endl;
-            machine.printGlobalsInfo();
-            machine.printVariablesInfo();
-            machine.printStack();
+            std::cerr << "Unable to open output file" << std::endl;
+            return EXIT_FAILURE;
         }
-        machine.step();
+        GobLang::CppTranslator translator(compiler.getByteCode());
+        translator.translate(out);
+        return EXIT_SUCCESS;
     }
-    // std::cout << "Value of a = " << std::get<int32_t>(machine.getVariableValue("a").value) << std::endl;
+    comp.printCode();
+    compiler.printCode();
+    byteCodeToText(compiler.getByteCode().operations);
+
+    GobLang::Machine machine(compiler.getByteCode(), natives);
+    machine.run();
+    // std::cout << "Value of a = " << machine.getVariableValue("a").getInt() << std::endl;
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -7,7 +7,23 @@ namespace GobLang::Compiler
     struct ByteCode
     {
         std::vector<std::string> ids;
+        /**
+         * @brief Names of native functions called with `CallNative`, operation uses index into this array.
+         * Machine binds them to its own functions by name
+         *
+         */
+        std::vector<std::string> natives;
         std::vector<int32_t> ints;
         std::vector<uint8_t> operations;
+        /**
+         * @brief Amount of local variables used by the code. Only set for register based code
+         *
+         */
+        size_t localCount = 0;
+        /**
+         * @brief Total amount of registers(local variables and temporary values) used by the code. 0 means that code is stack based
+         *
+         */
+        size_t registerCount = 0;
     };
-}
\ No newline at end of file
+}
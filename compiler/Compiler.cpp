@@ -4,6 +4,8 @@
 #include <iostream>
 #include <deque>
 #include <iterator>
+#include <set>
+#include <algorithm>
 
 void GobLang::Compiler::Compiler::compile()
 {
@@ -90,6 +92,8 @@ void GobLang::Compiler::Compiler::generateByteCode()
             if (!stack.empty())
             {
                 appendCompilerNode(*stack.rbegin(), true);
+                // value of the expression is not used by anything
+                m_byteCode.operations.push_back((uint8_t)Operation::Pop);
                 delete *stack.rbegin();
                 stack.pop_back();
             }
@@ -173,10 +177,28 @@ void GobLang::Compiler::Compiler::generateByteCode()
             }
             CompilerNode *funcNode = *stack.rbegin();
             stack.pop_back();
-            std::vector<uint8_t> fTemp = funcNode->getOperationGetBytes();
-            bytes.insert(bytes.end(), fTemp.begin(), fTemp.end());
+            int32_t nativeId = -1;
+            if (TokenCompilerNode *tokenNode = dynamic_cast<TokenCompilerNode *>(funcNode); tokenNode != nullptr)
+            {
+                if (IdToken *idToken = dynamic_cast<IdToken *>(tokenNode->getToken()); idToken != nullptr)
+                {
+                    nativeId = _getNativeId(m_parser.getIds()[idToken->getId()]);
+                }
+            }
+            if (nativeId != -1)
+            {
+                // function is known at compile time, so there is no need to look it up by name
+                bytes.push_back((uint8_t)Operation::CallNative);
+                bytes.push_back((uint8_t)nativeId);
+            }
+            else
+            {
+                std::vector<uint8_t> fTemp = funcNode->getOperationGetBytes();
+                bytes.insert(bytes.end(), fTemp.begin(), fTemp.end());
+                bytes.push_back((uint8_t)Operation::Call);
+            }
             delete funcNode;
-            bytes.push_back((uint8_t)Operation::Call);
+            bytes.push_back((uint8_t)func->getArgCount());
             stack.push_back(new OperationCompilerNode(bytes, isDestination, destMark));
         }
         else if (OperatorToken *opToken = dynamic_cast<OperatorToken *>(*it); opToken != nullptr)
@@ -251,6 +273,7 @@ void GobLang::Compiler::Compiler::generateByteCode()
     for (std::vector<CompilerNode *>::iterator it = stack.begin(); it != stack.end(); it++)
     {
         appendCompilerNode(*it, true);
+        m_byteCode.operations.push_back((uint8_t)Operation::Pop);
         delete (*it);
     }
     m_byteCode.operations.push_back((uint8_t)Operation::End);
@@ -267,6 +290,10 @@ void GobLang::Compiler::Compiler::generateByteCode()
             _placeAddressForMark((*it).first, m_byteCode.operations.size() - 1, false);
         }
     }
+    if (!m_registerBased || !_convertToRegisterCode())
+    {
+        _fuseOperations();
+    }
 }
 
 void GobLang::Compiler::Compiler::dumpStack()
@@ -473,20 +500,534 @@ void GobLang::Compiler::Compiler::_placeAddressForMark(size_t mark, size_t addre
          labelIt != m_jumpMarks[mark].end();
          labelIt++)
     {
-        for (int32_t i = sizeof(size_t) - 1; i >= 0; i--)
+        _writeAddress(*labelIt, address);
+    }
+    if (erase)
+    {
+        m_jumpMarks.erase(mark);
+    }
+}
+
+void GobLang::Compiler::Compiler::_writeAddress(size_t at, size_t address)
+{
+    for (int32_t i = sizeof(size_t) - 1; i >= 0; i--)
+    {
+        size_t offset = (sizeof(uint8_t) * i) * 8;
+        const size_t mask = 0xff;
+        size_t num = address & (mask << offset);
+        size_t numFixed = num >> offset;
+
+        m_byteCode.operations[at + (sizeof(size_t) - 1 - i)] = (uint8_t)numFixed;
+    }
+}
+
+size_t GobLang::Compiler::Compiler::_readAddress(size_t at) const
+{
+    size_t address = 0x0;
+    for (size_t i = 0; i < sizeof(size_t); i++)
+    {
+        address |= (size_t)m_byteCode.operations[at + i] << ((sizeof(size_t) - i - 1) * 8);
+    }
+    return address;
+}
+
+void GobLang::Compiler::Compiler::_fuseOperations()
+{
+    std::vector<uint8_t> const &code = m_byteCode.operations;
+    // start address of every operation and every address that is used as jump destination
+    std::vector<size_t> starts;
+    std::set<size_t> destinations;
+    for (size_t pc = 0; pc < code.size();)
+    {
+        OperationData const *data = getOperationData((Operation)code[pc]);
+        if (data == nullptr)
         {
-            size_t offset = (sizeof(uint8_t) * i) * 8;
-            const size_t mask = 0xff;
-            size_t num = address & (mask << offset);
-            size_t numFixed = num >> offset;
+            return;
+        }
+        starts.push_back(pc);
+        if (data->isJump)
+        {
+            destinations.insert(_readAddress(pc + 1 + data->argCount - sizeof(size_t)));
+        }
+        pc += 1 + data->argCount;
+    }
+    for (std::set<size_t>::iterator it = destinations.begin(); it != destinations.end(); it++)
+    {
+        // jumping into the middle of an operation can't be relocated, so it's safer to leave code untouched
+        if (!std::binary_search(starts.begin(), starts.end(), *it))
+        {
+            return;
+        }
+    }
+
+    auto opAt = [&](size_t i)
+    {
+        return i < starts.size() ? (Operation)code[starts[i]] : Operation::None;
+    };
+    auto argAt = [&](size_t i, size_t arg)
+    {
+        return code[starts[i] + 1 + arg];
+    };
+    // operations that are merged into the previous one can't be jumped to
+    auto canMerge = [&](size_t i, size_t count)
+    {
+        for (size_t j = i + 1; j < i + count; j++)
+        {
+            if (j >= starts.size() || destinations.count(starts[j]) > 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
 
-            m_byteCode.operations[(*labelIt) + (sizeof(size_t) - 1 - i)] = (uint8_t)numFixed;
+    std::vector<uint8_t> fused;
+    // old address -> new address
+    std::map<size_t, size_t> relocations;
+    // position of address in fused code -> old destination
+    std::vector<std::pair<size_t, size_t>> jumps;
+    for (size_t i = 0; i < starts.size();)
+    {
+        relocations[starts[i]] = fused.size();
+        // x = x + k; x = x - k;
+        if (opAt(i) == Operation::GetLocal &&
+            opAt(i + 1) == Operation::PushConstInt &&
+            (opAt(i + 2) == Operation::Add || opAt(i + 2) == Operation::Sub) &&
+            opAt(i + 3) == Operation::SetLocal &&
+            argAt(i, 0) == argAt(i + 3, 0) &&
+            canMerge(i, 4))
+        {
+            fused.push_back((uint8_t)(opAt(i + 2) == Operation::Add ? Operation::IncLocalByConst : Operation::DecLocalByConst));
+            fused.push_back(argAt(i, 0));
+            fused.push_back(argAt(i + 1, 0));
+            i += 4;
+        }
+        // while(a < b) or while (a < k)
+        else if (opAt(i) == Operation::GetLocal &&
+                 (opAt(i + 1) == Operation::GetLocal || opAt(i + 1) == Operation::PushConstInt) &&
+                 opAt(i + 2) == Operation::Less &&
+                 opAt(i + 3) == Operation::JumpIfNot &&
+                 canMerge(i, 4))
+        {
+            fused.push_back((uint8_t)(opAt(i + 1) == Operation::GetLocal ? Operation::JumpIfLocalNotLessLocal : Operation::JumpIfLocalNotLessConst));
+            fused.push_back(argAt(i, 0));
+            fused.push_back(argAt(i + 1, 0));
+            jumps.push_back({fused.size(), _readAddress(starts[i + 3] + 1)});
+            fused.insert(fused.end(), sizeof(size_t), 0x0);
+            i += 4;
+        }
+        // a[i]
+        else if (opAt(i) == Operation::GetLocal &&
+                 opAt(i + 1) == Operation::GetLocal &&
+                 opAt(i + 2) == Operation::GetArray &&
+                 canMerge(i, 3))
+        {
+            fused.push_back((uint8_t)Operation::GetLocalArrayItem);
+            fused.push_back(argAt(i + 1, 0));
+            fused.push_back(argAt(i, 0));
+            i += 3;
+        }
+        // reading global by name
+        else if (opAt(i) == Operation::PushConstString &&
+                 opAt(i + 1) == Operation::Get &&
+                 canMerge(i, 2))
+        {
+            fused.push_back((uint8_t)Operation::GetGlobalConst);
+            fused.push_back(argAt(i, 0));
+            i += 2;
+        }
+        else
+        {
+            OperationData const *data = getOperationData(opAt(i));
+            size_t end = (i + 1 < starts.size()) ? starts[i + 1] : code.size();
+            if (data->isJump)
+            {
+                jumps.push_back({fused.size() + (end - starts[i]) - sizeof(size_t), _readAddress(end - sizeof(size_t))});
+            }
+            fused.insert(fused.end(), code.begin() + starts[i], code.begin() + end);
+            i++;
         }
     }
-    if (erase)
+    m_byteCode.operations = fused;
+    for (std::vector<std::pair<size_t, size_t>>::iterator it = jumps.begin(); it != jumps.end(); it++)
     {
-        m_jumpMarks.erase(mark);
+        _writeAddress(it->first, relocations[it->second]);
+    }
+}
+
+bool GobLang::Compiler::Compiler::_convertToRegisterCode()
+{
+    std::vector<uint8_t> const &code = m_byteCode.operations;
+    std::vector<size_t> starts;
+    std::set<size_t> destinations;
+    size_t localCount = 0;
+    for (size_t pc = 0; pc < code.size();)
+    {
+        OperationData const *data = getOperationData((Operation)code[pc]);
+        if (data == nullptr)
+        {
+            return false;
+        }
+        starts.push_back(pc);
+        if (data->isJump)
+        {
+            destinations.insert(_readAddress(pc + 1 + data->argCount - sizeof(size_t)));
+        }
+        if ((Operation)code[pc] == Operation::GetLocal || (Operation)code[pc] == Operation::SetLocal)
+        {
+            localCount = std::max(localCount, (size_t)code[pc + 1] + 1);
+        }
+        pc += 1 + data->argCount;
+    }
+    for (std::set<size_t>::iterator it = destinations.begin(); it != destinations.end(); it++)
+    {
+        if (!std::binary_search(starts.begin(), starts.end(), *it))
+        {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Value on the simulated stack. Either register that holds the value or a string constant which is only loaded when needed,
+     * because global variable names don't need to be loaded at all
+     */
+    struct StackValue
+    {
+        bool isConstString;
+        size_t id;
+    };
+    std::vector<StackValue> stack;
+    size_t maxDepth = 0;
+    std::vector<uint8_t> out;
+    std::map<size_t, size_t> relocations;
+    std::vector<std::pair<size_t, size_t>> jumps;
+
+    auto temp = [&](size_t depth)
+    {
+        return localCount + depth;
+    };
+    auto emit = [&](Operation op, std::vector<size_t> const &args)
+    {
+        out.push_back((uint8_t)op);
+        for (std::vector<size_t>::const_iterator it = args.begin(); it != args.end(); it++)
+        {
+            out.push_back((uint8_t)*it);
+        }
+    };
+    auto emitJump = [&](Operation op, std::vector<size_t> const &args, size_t destination)
+    {
+        emit(op, args);
+        jumps.push_back({out.size(), destination});
+        out.insert(out.end(), sizeof(size_t), 0x0);
+    };
+    // move value into the temporary register that belongs to its stack slot
+    auto materialize = [&](size_t depth)
+    {
+        StackValue &val = stack[depth];
+        if (val.isConstString)
+        {
+            emit(Operation::RegLoadString, {temp(depth), val.id});
+        }
+        else if (val.id != temp(depth))
+        {
+            emit(Operation::RegMove, {temp(depth), val.id});
+        }
+        val = StackValue{.isConstString = false, .id = temp(depth)};
+    };
+    auto flush = [&]()
+    {
+        for (size_t i = 0; i < stack.size(); i++)
+        {
+            materialize(i);
+        }
+    };
+    // local variable is about to be changed, so any value that still reads it has to be copied first
+    auto detachLocal = [&](size_t local)
+    {
+        for (size_t i = 0; i < stack.size(); i++)
+        {
+            if (!stack[i].isConstString && stack[i].id == local)
+            {
+                materialize(i);
+            }
+        }
+    };
+    auto push = [&](StackValue val)
+    {
+        stack.push_back(val);
+        maxDepth = std::max(maxDepth, stack.size());
+    };
+    auto pushTemp = [&]()
+    {
+        size_t reg = temp(stack.size());
+        push(StackValue{.isConstString = false, .id = reg});
+        return reg;
+    };
+    auto popRegister = [&]()
+    {
+        if (stack.back().isConstString)
+        {
+            materialize(stack.size() - 1);
+        }
+        size_t reg = stack.back().id;
+        stack.pop_back();
+        return reg;
+    };
+    // results that are assigned to a local right away are written directly into the local
+    auto resultRegister = [&](size_t i)
+    {
+        if (i + 1 < starts.size() &&
+            (Operation)code[starts[i + 1]] == Operation::SetLocal &&
+            destinations.count(starts[i + 1]) == 0)
+        {
+            size_t local = code[starts[i + 1] + 1];
+            detachLocal(local);
+            return std::pair<size_t, bool>(local, true);
+        }
+        return std::pair<size_t, bool>(pushTemp(), false);
+    };
+
+    for (size_t i = 0; i < starts.size(); i++)
+    {
+        size_t pc = starts[i];
+        if (destinations.count(pc) > 0)
+        {
+            flush();
+        }
+        relocations[pc] = out.size();
+        Operation op = (Operation)code[pc];
+        switch (op)
+        {
+        case Operation::None:
+            break;
+        case Operation::Add:
+        case Operation::Sub:
+        case Operation::Equals:
+        case Operation::NotEq:
+        case Operation::Less:
+        case Operation::More:
+        case Operation::LessOrEq:
+        case Operation::MoreOrEq:
+        case Operation::And:
+        case Operation::Or:
+        {
+            static const std::map<Operation, Operation> binaryOperations = {
+                {Operation::Add, Operation::RegAdd},
+                {Operation::Sub, Operation::RegSub},
+                {Operation::Equals, Operation::RegEquals},
+                {Operation::NotEq, Operation::RegNotEq},
+                {Operation::Less, Operation::RegLess},
+                {Operation::More, Operation::RegMore},
+                {Operation::LessOrEq, Operation::RegLessOrEq},
+                {Operation::MoreOrEq, Operation::RegMoreOrEq},
+                {Operation::And, Operation::RegAnd},
+                {Operation::Or, Operation::RegOr},
+            };
+            size_t b = popRegister();
+            size_t a = popRegister();
+            std::pair<size_t, bool> dest = resultRegister(i);
+            emit(binaryOperations.at(op), {dest.first, a, b});
+            if (dest.second)
+            {
+                i++;
+            }
+        }
+        break;
+        case Operation::Not:
+        case Operation::Negate:
+        {
+            size_t a = popRegister();
+            std::pair<size_t, bool> dest = resultRegister(i);
+            emit(op == Operation::Not ? Operation::RegNot : Operation::RegNegate, {dest.first, a});
+            if (dest.second)
+            {
+                i++;
+            }
+        }
+        break;
+        case Operation::GetLocal:
+            push(StackValue{.isConstString = false, .id = code[pc + 1]});
+            break;
+        case Operation::SetLocal:
+        {
+            size_t val = popRegister();
+            detachLocal(code[pc + 1]);
+            if (val != code[pc + 1])
+            {
+                emit(Operation::RegMove, {code[pc + 1], val});
+            }
+        }
+        break;
+        case Operation::PushConstInt:
+        case Operation::PushConstChar:
+        case Operation::PushTrue:
+        case Operation::PushFalse:
+        {
+            std::pair<size_t, bool> dest = resultRegister(i);
+            if (op == Operation::PushConstInt)
+            {
+                emit(Operation::RegLoadInt, {dest.first, code[pc + 1]});
+            }
+            else if (op == Operation::PushConstChar)
+            {
+                emit(Operation::RegLoadChar, {dest.first, code[pc + 1]});
+            }
+            else
+            {
+                emit(Operation::RegLoadBool, {dest.first, op == Operation::PushTrue ? 1u : 0u});
+            }
+            if (dest.second)
+            {
+                i++;
+            }
+        }
+        break;
+        case Operation::PushConstString:
+            push(StackValue{.isConstString = true, .id = code[pc + 1]});
+            break;
+        case Operation::Get:
+        {
+            StackValue name = stack.back();
+            stack.pop_back();
+            if (!name.isConstString)
+            {
+                return false;
+            }
+            std::pair<size_t, bool> dest = resultRegister(i);
+            emit(Operation::RegGetGlobal, {dest.first, name.id});
+            if (dest.second)
+            {
+                i++;
+            }
+        }
+        break;
+        case Operation::Set:
+        {
+            size_t val = popRegister();
+            StackValue name = stack.back();
+            stack.pop_back();
+            if (!name.isConstString)
+            {
+                return false;
+            }
+            emit(Operation::RegSetGlobal, {name.id, val});
+        }
+        break;
+        case Operation::GetArray:
+        {
+            size_t array = popRegister();
+            size_t index = popRegister();
+            std::pair<size_t, bool> dest = resultRegister(i);
+            emit(Operation::RegGetArray, {dest.first, array, index});
+            if (dest.second)
+            {
+                i++;
+            }
+        }
+        break;
+        case Operation::SetArray:
+        {
+            size_t val = popRegister();
+            size_t array = popRegister();
+            size_t index = popRegister();
+            emit(Operation::RegSetArray, {array, index, val});
+        }
+        break;
+        case Operation::Call:
+        {
+            size_t func = popRegister();
+            size_t argCount = code[pc + 1];
+            size_t first = stack.size() - argCount;
+            // arguments have to be in consecutive registers
+            for (size_t arg = first; arg < stack.size(); arg++)
+            {
+                materialize(arg);
+            }
+            stack.resize(first);
+            std::pair<size_t, bool> dest = resultRegister(i);
+            emit(Operation::RegCall, {dest.first, func, temp(first), argCount});
+            if (dest.second)
+            {
+                i++;
+            }
+        }
+        break;
+        case Operation::CallNative:
+        {
+            size_t argCount = code[pc + 2];
+            size_t first = stack.size() - argCount;
+            for (size_t arg = first; arg < stack.size(); arg++)
+            {
+                materialize(arg);
+            }
+            stack.resize(first);
+            std::pair<size_t, bool> dest = resultRegister(i);
+            emit(Operation::RegCallNative, {dest.first, code[pc + 1], temp(first), argCount});
+            if (dest.second)
+            {
+                i++;
+            }
+        }
+        break;
+        case Operation::Pop:
+            stack.pop_back();
+            break;
+        case Operation::Jump:
+            flush();
+            emitJump(Operation::Jump, {}, _readAddress(pc + 1));
+            break;
+        case Operation::JumpIfNot:
+        {
+            size_t cond = popRegister();
+            flush();
+            emitJump(Operation::RegJumpIfNot, {cond}, _readAddress(pc + 1));
+        }
+        break;
+        case Operation::ShrinkLocal:
+            flush();
+            emit(Operation::ShrinkLocal, {code[pc + 1]});
+            break;
+        case Operation::End:
+            emit(Operation::End, {});
+            break;
+        default:
+            // anything else is not produced by the compiler
+            return false;
+        }
+    }
+    if (localCount + maxDepth > 0xff)
+    {
+        return false;
+    }
+    m_byteCode.operations = out;
+    for (std::vector<std::pair<size_t, size_t>>::iterator it = jumps.begin(); it != jumps.end(); it++)
+    {
+        _writeAddress(it->first, relocations[it->second]);
+    }
+    m_byteCode.localCount = localCount;
+    m_byteCode.registerCount = localCount + maxDepth;
+    return true;
+}
+
+int32_t GobLang::Compiler::Compiler::_getNativeId(std::string const &name)
+{
+    if (m_natives == nullptr || m_natives->find(name) == -1)
+    {
+        return -1;
+    }
+    std::vector<std::string> &natives = m_byteCode.natives;
+    std::vector<std::string>::iterator it = std::find(natives.begin(), natives.end(), name);
+    if (it != natives.end())
+    {
+        return it - natives.begin();
+    }
+    if (natives.size() > UINT8_MAX)
+    {
+        // id has to fit into one byte, so the rest of functions are called by name
+        return -1;
     }
+    natives.push_back(name);
+    return natives.size() - 1;
 }
 
 void GobLang::Compiler::Compiler::_compileSeparators(SeparatorToken *sepToken, std::vector<Token *>::const_iterator const &it)
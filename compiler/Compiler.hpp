@@ -5,12 +5,21 @@
 #include "ByteCode.hpp"
 #include "CompilerToken.hpp"
 #include "CompilerNode.hpp"
+#include "../execution/NativeRegistry.hpp"
 namespace GobLang::Compiler
 {
     class Compiler
     {
     public:
-        explicit Compiler(Parser const &parser) : m_parser(parser) {}
+        /**
+         * @brief Construct a new Compiler object
+         *
+         * @param parser Parser with parsed code
+         * @param registerBased If true register based byte code will be generated instead of stack based
+         * @param natives Native functions that will be available when the code runs. Calls to them are compiled into `CallNative`
+         */
+        explicit Compiler(Parser const &parser, bool registerBased = false, NativeRegistry const *natives = nullptr)
+            : m_parser(parser), m_registerBased(registerBased), m_natives(natives) {}
 
         /**
          * @brief Convert given parsed data into reverse polish notation representation of code
@@ -90,6 +99,48 @@ namespace GobLang::Compiler
         void _popVariableBlock();
         void _appendVariable(size_t stringId);
         void _placeAddressForMark(size_t mark, size_t address, bool erase);
+
+        /**
+         * @brief Write jump address into the byte code
+         *
+         * @param at Position of the first byte of the address
+         * @param address Address to write
+         */
+        void _writeAddress(size_t at, size_t address);
+
+        /**
+         * @brief Read jump address from the byte code
+         *
+         * @param at Position of the first byte of the address
+         * @return size_t Address
+         */
+        size_t _readAddress(size_t at) const;
+
+        /**
+         * @brief Replace common sequences of operations with fused operations that do the same work in a single dispatch.
+         * Must be called after all jump addresses are placed, since it moves operations around and updates the addresses
+         *
+         */
+        void _fuseOperations();
+
+        /**
+         * @brief Convert generated stack based code into register based code. Local variables keep their ids as register ids
+         * and every stack slot gets its own temporary register after the local variables.
+         * Must be called after all jump addresses are placed
+         *
+         * @return true Code was converted
+         * @return false Code can't be converted and was left as stack based code
+         */
+        bool _convertToRegisterCode();
+
+        /**
+         * @brief Get id of the native function in the byte code native table if function with this name is registered
+         *
+         * @param name Name used in the call
+         * @return int32_t Id of the native or -1 if the name is not a native function
+         */
+        int32_t _getNativeId(std::string const &name);
+
         void _compileSeparators(SeparatorToken *sepToken, std::vector<Token *>::const_iterator const &it);
 
         void _compileKeywords(KeywordToken *keyToken, std::vector<Token *>::const_iterator const &it);
@@ -148,6 +199,10 @@ namespace GobLang::Compiler
         size_t m_markCounter = 0;
 
         bool m_isVariableDeclaration = false;
+
+        bool m_registerBased = false;
+
+        NativeRegistry const *m_natives = nullptr;
     };
 
 }
\ No newline at end of file
@@ -1,28 +1,44 @@
 #include "Array.hpp"
 #include "Value.hpp"
 #include "Exception.hpp"
-GobLang::ArrayNode::ArrayNode(size_t size)
+#include <memory>
+#include <new>
+
+static_assert(sizeof(GobLang::ArrayNode) % alignof(GobLang::MemoryValue) == 0, "Items placed after the array node must be aligned");
+
+GobLang::ArrayNode::ArrayNode(size_t size) : MemoryNode(Kind), m_data(reinterpret_cast<MemoryValue *>(this + 1)), m_size(size)
+{
+    std::uninitialized_fill_n(m_data, size, MemoryValue::makeNull());
+}
+
+GobLang::ArrayNode *GobLang::ArrayNode::create(void *block, size_t size)
+{
+    return new (block) ArrayNode(size);
+}
+
+size_t GobLang::ArrayNode::getAllocationSize(size_t size)
 {
-    m_data = std::vector<MemoryValue>(size);
+    return sizeof(ArrayNode) + size * sizeof(MemoryValue);
 }
+
 void GobLang::ArrayNode::setItem(size_t i, MemoryValue const &item)
 {
-    if (i >= m_data.size())
+    if (i >= m_size)
     {
         throw RuntimeException(
             std::string("Attempted to read out of bounds of the array. i = ") +
             std::to_string(i) +
             " in array of size " +
-            std::to_string(m_data.size()));
+            std::to_string(m_size));
     }
     // check if object that we are setting is itself to avoid creating a ref cycle
-    if (item.type == Type::MemoryObj && std::get<MemoryNode *>(item.value) != this)
+    if (item.getType() == Type::MemoryObj && item.getObject() != this)
     {
-        std::get<MemoryNode *>(item.value)->increaseRefCount();
+        item.getObject()->increaseRefCount();
     }
-    if (m_data[i].type == Type::MemoryObj && std::get<MemoryNode *>(m_data[i].value) != this)
+    if (m_data[i].getType() == Type::MemoryObj && m_data[i].getObject() != this)
     {
-        std::get<MemoryNode *>(m_data[i].value)->decreaseRefCount();
+        m_data[i].getObject()->decreaseRefCount();
     }
     m_data[i] = item;
 }
@@ -30,7 +46,7 @@ void GobLang::ArrayNode::setItem(size_t i, MemoryValue const &item)
 GobLang::MemoryValue *GobLang::ArrayNode::getItem(size_t i)
 {
 
-    if (i < m_data.size())
+    if (i < m_size)
     {
         return &m_data[i];
     }
@@ -40,7 +56,7 @@ GobLang::MemoryValue *GobLang::ArrayNode::getItem(size_t i)
             std::string("Attempted to read out of bounds of the array. i = ") +
             std::to_string(i) +
             " in array of size " +
-            std::to_string(m_data.size()));
+            std::to_string(m_size));
         return nullptr;
     }
 }
@@ -48,24 +64,13 @@ GobLang::MemoryValue *GobLang::ArrayNode::getItem(size_t i)
 std::string GobLang::ArrayNode::toString()
 {
     std::string text = "[";
-    for (size_t i = 0; i < m_data.size(); i++)
+    for (size_t i = 0; i < m_size; i++)
     {
         text += valueToString(m_data[i]);
-        if (i != m_data.size() - 1)
+        if (i != m_size - 1)
         {
             text += ",";
         }
     }
     return text + "]";
 }
-
-GobLang::ArrayNode::~ArrayNode()
-{
-    for (std::vector<MemoryValue>::iterator it = m_data.begin(); it != m_data.end(); it++)
-    {
-        if (it->type == Type::MemoryObj)
-        {
-            std::get<MemoryNode *>(it->value)->decreaseRefCount();
-        }
-    }
-}
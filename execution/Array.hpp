@@ -3,22 +3,51 @@
 
 namespace GobLang
 {
-    struct MemoryValue;
+    class MemoryValue;
+    /**
+     * @brief Array of values with fixed size. Items are stored in the same block of memory right after the node,
+     * so arrays can only be created by `create` in a block of `getAllocationSize` bytes
+     *
+     */
     class ArrayNode : public MemoryNode
     {
     public:
-        explicit ArrayNode(size_t size);
+        static constexpr MemoryKind Kind = MemoryKind::Array;
+
+        /**
+         * @brief Construct a new array in the given block of memory. Array is destroyed by calling the destructor, block is not freed
+         *
+         * @param block Memory of at least `getAllocationSize(size)` bytes, aligned for any value
+         * @param size Amount of items
+         * @return ArrayNode* Array that starts at the beginning of the block
+         */
+        static ArrayNode *create(void *block, size_t size);
+
+        /**
+         * @brief Get amount of bytes needed to store the array node together with its items
+         *
+         * @param size Amount of items
+         */
+        static size_t getAllocationSize(size_t size);
 
         void setItem(size_t i, MemoryValue const &item);
         MemoryValue *getItem(size_t i);
 
         std::string toString() override;
 
-        size_t getSize() const { return m_data.size(); }
+        size_t getSize() const { return m_size; }
 
-        virtual ~ArrayNode();
+        /**
+         * @brief Destroy the array. References held by items are released by the machine before deleting the array,
+         * so that it can collect items that are no longer used
+         *
+         */
+        virtual ~ArrayNode() = default;
 
     private:
-        std::vector<MemoryValue> m_data;
+        explicit ArrayNode(size_t size);
+
+        MemoryValue *m_data;
+        size_t m_size;
     };
 } // namespace SimpleLang
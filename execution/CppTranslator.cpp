@@ -0,0 +1,584 @@
+#include "CppTranslator.hpp"
+#include "Machine.hpp"
+#include "Verifier.hpp"
+#include <cstdio>
+#include <set>
+
+/**
+ * @brief Start of every translated program. Helpers perform the same checks and throw the same errors as the interpreter
+ */
+static const char *const TranslatedPrologue = R"(#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "execution/Machine.hpp"
+#include "standard/MachineFunctions.hpp"
+
+namespace
+{
+    using GobLang::MemoryValue;
+    using GobLang::Type;
+
+    void checkSameType(MemoryValue const &a, MemoryValue const &b)
+    {
+        if (a.getType() != b.getType())
+        {
+            throw GobLang::RuntimeException(std::string("Attempted to compare value of ") + GobLang::typeToString(a.getType()) + " and " + GobLang::typeToString(b.getType()));
+        }
+    }
+
+    template <typename Compare>
+    MemoryValue compare(MemoryValue const &a, MemoryValue const &b, Compare cmp)
+    {
+        checkSameType(a, b);
+        switch (a.getType())
+        {
+        case Type::Int:
+            return MemoryValue::makeBool(cmp(a.getInt(), b.getInt()));
+        case Type::Number:
+            return MemoryValue::makeBool(cmp(a.getNumber(), b.getNumber()));
+        default:
+            throw GobLang::RuntimeException(std::string("Attempted to compare value of type ") + GobLang::typeToString(a.getType()) +
+                                            ". Only numeric types can be compared using >,<, <=, >=");
+        }
+    }
+
+    MemoryValue arithmetic(MemoryValue const &a, MemoryValue const &b, bool isAdd)
+    {
+        if (a.getType() != Type::Int || b.getType() != Type::Int)
+        {
+            throw GobLang::RuntimeException(std::string(isAdd ? "Attempted to add values of " : "Attempted to subtract values of ") + GobLang::typeToString(a.getType()) + " and " + GobLang::typeToString(b.getType()));
+        }
+        return MemoryValue::makeInt(isAdd ? a.getInt() + b.getInt() : a.getInt() - b.getInt());
+    }
+
+    MemoryValue equals(MemoryValue const &a, MemoryValue const &b, bool expected)
+    {
+        checkSameType(a, b);
+        return MemoryValue::makeBool(GobLang::areEqual(a, b) == expected);
+    }
+
+    MemoryValue logical(MemoryValue const &a, MemoryValue const &b, bool isAnd)
+    {
+        if (a.getType() != Type::Bool || b.getType() != Type::Bool)
+        {
+            throw GobLang::RuntimeException(std::string(isAnd ? "Attempted to 'and' values of " : "Attempted to 'or' values of ") + GobLang::typeToString(a.getType()) + " and " + GobLang::typeToString(b.getType()));
+        }
+        return MemoryValue::makeBool(isAnd ? (a.getBool() && b.getBool()) : (a.getBool() || b.getBool()));
+    }
+
+    MemoryValue logicalNot(MemoryValue const &val)
+    {
+        if (val.getType() != Type::Bool)
+        {
+            throw GobLang::RuntimeException("Attempted to negate non boolean value");
+        }
+        return MemoryValue::makeBool(!val.getBool());
+    }
+
+    MemoryValue negate(MemoryValue const &val)
+    {
+        switch (val.getType())
+        {
+        case Type::Int:
+            return MemoryValue::makeInt(-val.getInt());
+        case Type::Number:
+            return MemoryValue::makeNumber(-val.getNumber());
+        default:
+            throw GobLang::RuntimeException("Attempted to apply negate operation on a non numeric value");
+        }
+    }
+
+    bool condition(MemoryValue const &val)
+    {
+        if (val.getType() != Type::Bool)
+        {
+            throw GobLang::RuntimeException(std::string("Invalid data type passed to condition check. Expected bool got: ") + GobLang::typeToString(val.getType()));
+        }
+        return val.getBool();
+    }
+
+    MemoryValue callNative(GobLang::Machine &machine, int64_t id, const char *name, size_t argCount)
+    {
+        if (id == -1)
+        {
+            throw GobLang::RuntimeException(std::string("Attempted to call native function '") + name + "', which doesn't exist");
+        }
+        return machine.callNative(id, argCount);
+    }
+
+    GobLang::StringNode *asString(MemoryValue const &val)
+    {
+        return GobLang::memoryCast<GobLang::StringNode>(val.getObject());
+    }
+
+    const auto less = [](auto a, auto b) { return a < b; };
+    const auto more = [](auto a, auto b) { return a > b; };
+    const auto lessOrEq = [](auto a, auto b) { return a <= b; };
+    const auto moreOrEq = [](auto a, auto b) { return a >= b; };
+}
+
+)";
+
+/**
+ * @brief End of every translated program, uses the same set of native functions as the `goblang` executable
+ */
+static const char *const TranslatedMain = R"(
+#ifndef GOB_TRANSLATED_NO_MAIN
+int main()
+{
+    GobLang::NativeRegistry natives;
+    MachineFunctions::addStandardFunctions(natives);
+    GobLang::Machine machine(GobLang::Compiler::ByteCode{}, natives);
+    try
+    {
+        runTranslatedProgram(machine);
+    }
+    catch (GobLang::RuntimeException const &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+#endif
+)";
+
+GobLang::CppTranslator::CppTranslator(Compiler::ByteCode const &code) : m_constStrings(code.ids), m_nativeNames(code.natives), m_registerBase(code.localCount)
+{
+    // machine decodes and verifies the code exactly like it would before running it
+    Machine machine(code);
+    m_instructions = machine.getInstructions();
+    Verifier verifier(m_instructions, m_constStrings.size(), m_nativeNames.size());
+    verifier.verify();
+    m_maxStackDepth = verifier.getMaxStackDepth();
+    m_localCount = verifier.getLocalCount();
+    m_depths.resize(m_instructions.size());
+    m_jumpTargets.assign(m_instructions.size(), false);
+    for (size_t i = 0; i < m_instructions.size(); i++)
+    {
+        m_depths[i] = verifier.getStackDepth(i);
+        if (getOperationData(m_instructions[i].op)->isJump)
+        {
+            m_jumpTargets[m_instructions[i].target] = true;
+        }
+    }
+    _findConstNames();
+}
+
+void GobLang::CppTranslator::translate(std::ostream &out)
+{
+    out << "// Generated by gobc --emit-cpp, build together with the GobLang runtime" << std::endl;
+    out << TranslatedPrologue;
+    out << "void runTranslatedProgram(GobLang::Machine &machine)" << std::endl;
+    out << "{" << std::endl;
+    if (m_localCount > 0)
+    {
+        // storage is never resized after this, because code doesn't address anything past the verified amount of variables
+        out << "    machine.reserveLocalVariables(" << m_localCount << ");" << std::endl;
+        out << "    MemoryValue *locals = machine.getLocalVariableValue(0);" << std::endl;
+    }
+    for (size_t i = 0; i < m_maxStackDepth; i++)
+    {
+        out << "    MemoryValue " << _slot(i) << ";" << std::endl;
+    }
+    // natives are bound by name once, same as when the machine loads the byte code
+    for (size_t i = 0; i < m_nativeNames.size(); i++)
+    {
+        out << "    const int64_t " << _native(i) << " = machine.findNativeFunction(" << _quote(m_nativeNames[i]) << ");" << std::endl;
+    }
+    std::set<uint8_t> temporaries;
+    for (Instruction const &instr : m_instructions)
+    {
+        if (!isRegisterOperation(instr.op))
+        {
+            continue;
+        }
+        // second operand of `RegCallNative` is id of the function rather than a register
+        uint8_t second = instr.op == Operation::RegCallNative ? instr.a : instr.b;
+        for (uint8_t reg : {instr.a, second, instr.c})
+        {
+            if (reg >= m_registerBase)
+            {
+                temporaries.insert(reg);
+            }
+        }
+        if (instr.op == Operation::RegCall || instr.op == Operation::RegCallNative)
+        {
+            for (int32_t i = 0; i < instr.value; i++)
+            {
+                if ((size_t)(instr.c + i) >= m_registerBase)
+                {
+                    temporaries.insert(instr.c + i);
+                }
+            }
+        }
+    }
+    for (uint8_t reg : temporaries)
+    {
+        out << "    MemoryValue " << _reg(reg) << ";" << std::endl;
+    }
+    for (size_t i = 0; i < m_instructions.size(); i++)
+    {
+        // unreachable code is never executed, so there is no need to translate it
+        if (m_depths[i] == -1)
+        {
+            continue;
+        }
+        if (m_jumpTargets[i])
+        {
+            out << "L" << i << ":" << std::endl;
+        }
+        _translateInstruction(i, out);
+    }
+    out << "}" << std::endl;
+    out << TranslatedMain;
+}
+
+void GobLang::CppTranslator::_findConstNames()
+{
+    m_constNames.assign(m_instructions.size(), -1);
+    m_skipped.assign(m_instructions.size(), false);
+    for (size_t i = 0; i < m_instructions.size(); i++)
+    {
+        if (m_instructions[i].op != Operation::PushConstString || m_depths[i] == -1)
+        {
+            continue;
+        }
+        int64_t slot = m_depths[i];
+        // follow straight line code until something uses the string
+        for (size_t j = i + 1; j < m_instructions.size() && !m_jumpTargets[j]; j++)
+        {
+            Instruction const &instr = m_instructions[j];
+            if (instr.op == Operation::Set && m_depths[j] - 2 == slot)
+            {
+                m_constNames[j] = m_instructions[i].a;
+                m_skipped[i] = true;
+                break;
+            }
+            int32_t pop, push;
+            getStackEffect(instr, pop, push);
+            if (m_depths[j] - pop <= slot || getOperationData(instr.op)->isJump || instr.op == Operation::End)
+            {
+                break;
+            }
+        }
+    }
+}
+
+void GobLang::CppTranslator::_translateInstruction(size_t at, std::ostream &out)
+{
+    Instruction const &instr = m_instructions[at];
+    int64_t d = m_depths[at];
+    std::string top = d > 0 ? _slot(d - 1) : "";
+    std::string second = d > 1 ? _slot(d - 2) : "";
+    std::string next = _slot(d);
+    std::string target = "L" + std::to_string(instr.target);
+    switch (instr.op)
+    {
+    case Operation::None:
+        break;
+    case Operation::Add:
+    case Operation::AddIntInt:
+        out << "    " << second << " = arithmetic(" << second << ", " << top << ", true);" << std::endl;
+        break;
+    case Operation::Sub:
+        out << "    " << second << " = arithmetic(" << second << ", " << top << ", false);" << std::endl;
+        break;
+    case Operation::Call:
+    {
+        int64_t first = d - 1 - instr.a;
+        for (int64_t i = first; i < d - 1; i++)
+        {
+            out << "    machine.pushToStack(" << _slot(i) << ");" << std::endl;
+        }
+        out << "    " << _slot(first) << " = machine.callFunction(" << top << ", " << (int32_t)instr.a << ");" << std::endl;
+        break;
+    }
+    case Operation::CallNative:
+    {
+        int64_t first = d - instr.b;
+        for (int64_t i = first; i < d; i++)
+        {
+            out << "    machine.pushToStack(" << _slot(i) << ");" << std::endl;
+        }
+        out << "    " << _slot(first) << " = " << _callNative(instr.a, instr.b) << ";" << std::endl;
+        break;
+    }
+    case Operation::Set:
+        if (m_constNames[at] != -1)
+        {
+            out << "    machine.setGlobal(" << _constString(m_constNames[at]) << ", " << top << ");" << std::endl;
+        }
+        else
+        {
+            out << "    if (GobLang::StringNode *name = asString(" << second << "); name != nullptr)" << std::endl;
+            out << "    {" << std::endl;
+            out << "        machine.setGlobal(name->getString(), " << top << ");" << std::endl;
+            out << "    }" << std::endl;
+        }
+        out << "    machine.collectGarbageIfNeeded();" << std::endl;
+        break;
+    case Operation::Get:
+        out << "    " << top << " = machine.getGlobal(asString(" << top << ")->getString());" << std::endl;
+        break;
+    case Operation::GetLocal:
+        out << "    " << next << " = locals[" << (int32_t)instr.a << "];" << std::endl;
+        break;
+    case Operation::SetLocal:
+        out << "    machine.setLocalVariableValue(" << (int32_t)instr.a << ", " << top << ");" << std::endl;
+        out << "    machine.collectGarbageIfNeeded();" << std::endl;
+        break;
+    case Operation::GetArray:
+    case Operation::GetArrayIndexInt:
+        out << "    " << second << " = machine.getArrayItem(" << top << ", " << second << ");" << std::endl;
+        break;
+    case Operation::SetArray:
+        out << "    machine.setArrayItem(" << second << ", " << _slot(d - 3) << ", " << top << ");" << std::endl;
+        out << "    machine.collectGarbageIfNeeded();" << std::endl;
+        break;
+    case Operation::PushConstInt:
+        out << "    " << next << " = MemoryValue::makeInt((int32_t)" << instr.value << ");" << std::endl;
+        break;
+    case Operation::PushConstChar:
+        out << "    " << next << " = MemoryValue::makeChar((char)" << instr.value << ");" << std::endl;
+        break;
+    case Operation::PushConstString:
+        if (!m_skipped[at])
+        {
+            out << "    " << next << " = MemoryValue::makeObject(machine.createString(" << _constString(instr.a) << ", true));" << std::endl;
+        }
+        break;
+    case Operation::PushTrue:
+        out << "    " << next << " = MemoryValue::makeBool(true);" << std::endl;
+        break;
+    case Operation::PushFalse:
+        out << "    " << next << " = MemoryValue::makeBool(false);" << std::endl;
+        break;
+    case Operation::Equals:
+    case Operation::EqChar:
+        out << "    " << second << " = equals(" << second << ", " << top << ", true);" << std::endl;
+        break;
+    case Operation::NotEq:
+        out << "    " << second << " = equals(" << second << ", " << top << ", false);" << std::endl;
+        break;
+    case Operation::Less:
+    case Operation::LessIntInt:
+        out << "    " << second << " = compare(" << second << ", " << top << ", less);" << std::endl;
+        break;
+    case Operation::More:
+        out << "    " << second << " = compare(" << second << ", " << top << ", more);" << std::endl;
+        break;
+    case Operation::LessOrEq:
+        out << "    " << second << " = compare(" << second << ", " << top << ", lessOrEq);" << std::endl;
+        break;
+    case Operation::MoreOrEq:
+        out << "    " << second << " = compare(" << second << ", " << top << ", moreOrEq);" << std::endl;
+        break;
+    case Operation::And:
+    case Operation::Or:
+        out << "    " << second << " = logical(" << second << ", " << top << ", " << (instr.op == Operation::And ? "true" : "false") << ");" << std::endl;
+        break;
+    case Operation::Not:
+        out << "    " << top << " = logicalNot(" << top << ");" << std::endl;
+        break;
+    case Operation::Negate:
+        out << "    " << top << " = negate(" << top << ");" << std::endl;
+        break;
+    case Operation::Jump:
+        out << "    goto " << target << ";" << std::endl;
+        break;
+    case Operation::JumpIfNot:
+        out << "    if (!condition(" << top << "))" << std::endl;
+        out << "        goto " << target << ";" << std::endl;
+        break;
+    case Operation::ShrinkLocal:
+        out << "    machine.shrinkLocalVariableStackBy(" << (int32_t)instr.a << ");" << std::endl;
+        out << "    machine.collectGarbageIfNeeded();" << std::endl;
+        break;
+    case Operation::IncLocalByConst:
+    case Operation::DecLocalByConst:
+        out << "    locals[" << (int32_t)instr.a << "] = arithmetic(locals[" << (int32_t)instr.a << "], MemoryValue::makeInt((int32_t)" << instr.value << "), "
+            << (instr.op == Operation::IncLocalByConst ? "true" : "false") << ");" << std::endl;
+        break;
+    case Operation::JumpIfLocalNotLessLocal:
+        out << "    if (!compare(locals[" << (int32_t)instr.a << "], locals[" << (int32_t)instr.b << "], less).getBool())" << std::endl;
+        out << "        goto " << target << ";" << std::endl;
+        break;
+    case Operation::JumpIfLocalNotLessConst:
+        out << "    if (locals[" << (int32_t)instr.a << "].getType() != Type::Int)" << std::endl;
+        out << "        throw GobLang::RuntimeException(std::string(\"Attempted to compare value of \") + GobLang::typeToString(locals[" << (int32_t)instr.a
+            << "].getType()) + \" and \" + GobLang::typeToString(Type::Int));" << std::endl;
+        out << "    if (!(locals[" << (int32_t)instr.a << "].getInt() < (int32_t)" << instr.value << "))" << std::endl;
+        out << "        goto " << target << ";" << std::endl;
+        break;
+    case Operation::GetLocalArrayItem:
+        out << "    " << next << " = machine.getArrayItem(locals[" << (int32_t)instr.a << "], locals[" << (int32_t)instr.b << "]);" << std::endl;
+        break;
+    case Operation::GetGlobalConst:
+        out << "    " << next << " = machine.getGlobal(" << _constString(instr.a) << ");" << std::endl;
+        break;
+    case Operation::Pop:
+        break;
+    case Operation::RegMove:
+        out << "    " << _setReg(instr.a, _reg(instr.b)) << std::endl;
+        if (instr.a < m_registerBase)
+        {
+            out << "    machine.collectGarbageIfNeeded();" << std::endl;
+        }
+        break;
+    case Operation::RegLoadInt:
+        out << "    " << _setReg(instr.a, "MemoryValue::makeInt((int32_t)" + std::to_string(instr.value) + ")") << std::endl;
+        break;
+    case Operation::RegLoadChar:
+        out << "    " << _setReg(instr.a, "MemoryValue::makeChar((char)" + std::to_string(instr.value) + ")") << std::endl;
+        break;
+    case Operation::RegLoadBool:
+        out << "    " << _setReg(instr.a, std::string("MemoryValue::makeBool(") + (instr.value != 0 ? "true" : "false") + ")") << std::endl;
+        break;
+    case Operation::RegLoadString:
+        out << "    " << _setReg(instr.a, "MemoryValue::makeObject(machine.createString(" + _constString(instr.b) + ", true))") << std::endl;
+        break;
+    case Operation::RegGetGlobal:
+        out << "    " << _setReg(instr.a, "machine.getGlobal(" + _constString(instr.b) + ")") << std::endl;
+        break;
+    case Operation::RegSetGlobal:
+        out << "    machine.setGlobal(" << _constString(instr.a) << ", " << _reg(instr.b) << ");" << std::endl;
+        out << "    machine.collectGarbageIfNeeded();" << std::endl;
+        break;
+    case Operation::RegAdd:
+    case Operation::RegSub:
+        out << "    " << _setReg(instr.a, "arithmetic(" + _reg(instr.b) + ", " + _reg(instr.c) + (instr.op == Operation::RegAdd ? ", true)" : ", false)")) << std::endl;
+        break;
+    case Operation::RegEquals:
+    case Operation::RegNotEq:
+        out << "    " << _setReg(instr.a, "equals(" + _reg(instr.b) + ", " + _reg(instr.c) + (instr.op == Operation::RegEquals ? ", true)" : ", false)")) << std::endl;
+        break;
+    case Operation::RegLess:
+        out << "    " << _setReg(instr.a, "compare(" + _reg(instr.b) + ", " + _reg(instr.c) + ", less)") << std::endl;
+        break;
+    case Operation::RegMore:
+        out << "    " << _setReg(instr.a, "compare(" + _reg(instr.b) + ", " + _reg(instr.c) + ", more)") << std::endl;
+        break;
+    case Operation::RegLessOrEq:
+        out << "    " << _setReg(instr.a, "compare(" + _reg(instr.b) + ", " + _reg(instr.c) + ", lessOrEq)") << std::endl;
+        break;
+    case Operation::RegMoreOrEq:
+        out << "    " << _setReg(instr.a, "compare(" + _reg(instr.b) + ", " + _reg(instr.c) + ", moreOrEq)") << std::endl;
+        break;
+    case Operation::RegAnd:
+    case Operation::RegOr:
+        out << "    " << _setReg(instr.a, "logical(" + _reg(instr.b) + ", " + _reg(instr.c) + (instr.op == Operation::RegAnd ? ", true)" : ", false)")) << std::endl;
+        break;
+    case Operation::RegNot:
+        out << "    " << _setReg(instr.a, "logicalNot(" + _reg(instr.b) + ")") << std::endl;
+        break;
+    case Operation::RegNegate:
+        out << "    " << _setReg(instr.a, "negate(" + _reg(instr.b) + ")") << std::endl;
+        break;
+    case Operation::RegGetArray:
+        out << "    " << _setReg(instr.a, "machine.getArrayItem(" + _reg(instr.b) + ", " + _reg(instr.c) + ")") << std::endl;
+        break;
+    case Operation::RegSetArray:
+        out << "    machine.setArrayItem(" << _reg(instr.a) << ", " << _reg(instr.b) << ", " << _reg(instr.c) << ");" << std::endl;
+        out << "    machine.collectGarbageIfNeeded();" << std::endl;
+        break;
+    case Operation::RegCall:
+        for (int32_t i = 0; i < instr.value; i++)
+        {
+            out << "    machine.pushToStack(" << _reg(instr.c + i) << ");" << std::endl;
+        }
+        out << "    " << _setReg(instr.a, "machine.callFunction(" + _reg(instr.b) + ", " + std::to_string(instr.value) + ")") << std::endl;
+        break;
+    case Operation::RegCallNative:
+        for (int32_t i = 0; i < instr.value; i++)
+        {
+            out << "    machine.pushToStack(" << _reg(instr.c + i) << ");" << std::endl;
+        }
+        out << "    " << _setReg(instr.a, _callNative(instr.b, instr.value)) << std::endl;
+        break;
+    case Operation::RegJumpIfNot:
+        out << "    if (!condition(" << _reg(instr.a) << "))" << std::endl;
+        out << "        goto " << target << ";" << std::endl;
+        break;
+    case Operation::End:
+        out << "    return;" << std::endl;
+        break;
+    }
+}
+
+std::string GobLang::CppTranslator::_slot(int64_t id) const
+{
+    return "s" + std::to_string(id);
+}
+
+std::string GobLang::CppTranslator::_native(size_t id) const
+{
+    return "native" + std::to_string(id);
+}
+
+std::string GobLang::CppTranslator::_callNative(size_t id, size_t argCount) const
+{
+    return "callNative(machine, " + _native(id) + ", " + _quote(m_nativeNames[id]) + ", " + std::to_string(argCount) + ")";
+}
+
+std::string GobLang::CppTranslator::_reg(uint8_t id) const
+{
+    if (id < m_registerBase)
+    {
+        return "locals[" + std::to_string(id) + "]";
+    }
+    return "r" + std::to_string(id);
+}
+
+std::string GobLang::CppTranslator::_setReg(uint8_t id, std::string const &val) const
+{
+    if (id < m_registerBase)
+    {
+        return "machine.setLocalVariableValue(" + std::to_string(id) + ", " + val + ");";
+    }
+    return _reg(id) + " = " + val + ";";
+}
+
+std::string GobLang::CppTranslator::_constString(size_t id) const
+{
+    return _quote(m_constStrings[id]);
+}
+
+std::string GobLang::CppTranslator::_quote(std::string const &str)
+{
+    std::string res = "\"";
+    for (char c : str)
+    {
+        switch (c)
+        {
+        case '"':
+            res += "\\\"";
+            break;
+        case '\\':
+            res += "\\\\";
+            break;
+        case '\n':
+            res += "\\n";
+            break;
+        case '\t':
+            res += "\\t";
+            break;
+        case '\r':
+            res += "\\r";
+            break;
+        default:
+            if ((unsigned char)c < 0x20 || (unsigned char)c >= 0x7f)
+            {
+                // octal escapes always use 3 digits so following characters can't be mistaken for a part of the escape
+                char buf[5];
+                snprintf(buf, sizeof(buf), "\\%03o", (unsigned char)c);
+                res += buf;
+            }
+            else
+            {
+                res += c;
+            }
+        }
+    }
+    return res + "\"";
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+#include "Operations.hpp"
+#include "../compiler/ByteCode.hpp"
+
+namespace GobLang
+{
+    /**
+     * @brief Ahead of time translation of byte code into a C++ translation unit. Every instruction becomes straight line C++ code
+     * and jumps become gotos. Operation stack slots become local variables because verifier guarantees that each instruction
+     * always sees the same stack depth. Generated code uses the `Machine` for memory, globals, local variables and native functions
+     *
+     */
+    class CppTranslator
+    {
+    public:
+        /**
+         * @brief Prepare the byte code for translation. Byte code is decoded and verified the same way as when loading it into the `Machine`,
+         * so invalid code is rejected with RuntimeException
+         *
+         * @param code Byte code to translate
+         */
+        explicit CppTranslator(Compiler::ByteCode const &code);
+
+        /**
+         * @brief Generate the translation unit. Program is placed in `void runTranslatedProgram(GobLang::Machine &machine)`,
+         * followed by `main` that registers standard functions and runs it. Define `GOB_TRANSLATED_NO_MAIN` to leave `main` out,
+         * for example when building a shared object
+         *
+         * @param out Stream to write the source into
+         */
+        void translate(std::ostream &out);
+
+    private:
+        /**
+         * @brief Find `PushConstString` instructions whose string is only used as the name for the `Set` operation.
+         * Such names are passed to the machine directly instead of creating a string object every time
+         *
+         */
+        void _findConstNames();
+
+        void _translateInstruction(size_t at, std::ostream &out);
+
+        /**
+         * @brief Get C++ expression for the operation stack slot
+         *
+         * @param id Depth of the slot, 0 is the bottom of the stack
+         */
+        std::string _slot(int64_t id) const;
+
+        /**
+         * @brief Get C++ expression for the register
+         *
+         */
+        std::string _reg(uint8_t id) const;
+
+        /**
+         * @brief Get C++ statement that writes the value into the register. Local variables go through the machine to keep reference counts
+         *
+         */
+        std::string _setReg(uint8_t id, std::string const &val) const;
+
+        std::string _constString(size_t id) const;
+
+        /**
+         * @brief Get name of the local variable that holds id of the native function from the byte code native table
+         *
+         */
+        std::string _native(size_t id) const;
+
+        /**
+         * @brief Get C++ expression that calls the native function with arguments that are already on the machine stack
+         *
+         */
+        std::string _callNative(size_t id, size_t argCount) const;
+
+        /**
+         * @brief Escape the string into a C++ string literal
+         *
+         */
+        static std::string _quote(std::string const &str);
+
+        std::vector<Instruction> m_instructions;
+        std::vector<std::string> m_constStrings;
+        std::vector<std::string> m_nativeNames;
+        /**
+         * @brief Id of the first temporary register, registers before it are local variables
+         *
+         */
+        size_t m_registerBase;
+        std::vector<int64_t> m_depths;
+        size_t m_maxStackDepth = 0;
+        size_t m_localCount = 0;
+        std::vector<bool> m_jumpTargets;
+        /**
+         * @brief Id of the string constant used as name by the `Set` instruction at the same index, -1 if name is computed at runtime
+         *
+         */
+        std::vector<int64_t> m_constNames;
+        /**
+         * @brief `PushConstString` instructions that don't need to create the string
+         *
+         */
+        std::vector<bool> m_skipped;
+    };
+}
@@ -0,0 +1,849 @@
+#include "Jit.hpp"
+#include <cstring>
+#include <map>
+
+#ifdef GOB_JIT_AVAILABLE
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+    using GobLang::Instruction;
+    using GobLang::Operation;
+
+    /**
+     * @brief Type of a value on the operation stack inside of compiled code
+     *
+     */
+    enum class JitType
+    {
+        Int,
+        Bool
+    };
+
+    /**
+     * @brief Minimal x86-64 code emitter. Compiled code receives pointer to unboxed local variables in rdi and pointer to the budget in rsi,
+     * keeps the budget in rdx, uses the machine stack as the operation stack and returns id of the exit in eax
+     *
+     */
+    class Assembler
+    {
+    public:
+        size_t size() const { return m_code.size(); }
+
+        std::vector<uint8_t> const &getCode() const { return m_code; }
+
+        void pushRax()
+        {
+            _byte(0x50);
+            m_pushRaxEnd = m_code.size();
+        }
+
+        void popRax()
+        {
+            if (_removePushRax())
+            {
+                return;
+            }
+            _byte(0x58);
+        }
+
+        void popRcx()
+        {
+            if (_removePushRax())
+            {
+                // mov ecx, eax
+                _bytes({0x89, 0xc1});
+                return;
+            }
+            _byte(0x59);
+        }
+
+        void pushImm(int32_t val)
+        {
+            _byte(0x68);
+            _int(val);
+        }
+
+        void loadLocal(uint8_t id)
+        {
+            // mov eax, [rdi + id * 4]
+            _bytes({0x8b, 0x87});
+            _int(id * 4);
+        }
+
+        void storeLocal(uint8_t id)
+        {
+            // mov [rdi + id * 4], eax
+            _bytes({0x89, 0x87});
+            _int(id * 4);
+        }
+
+        void addToLocal(uint8_t id, int32_t val)
+        {
+            // add dword [rdi + id * 4], val
+            _bytes({0x81, 0x87});
+            _int(id * 4);
+            _int(val);
+        }
+
+        void subFromLocal(uint8_t id, int32_t val)
+        {
+            // sub dword [rdi + id * 4], val
+            _bytes({0x81, 0xaf});
+            _int(id * 4);
+            _int(val);
+        }
+
+        void compareLocalWithConst(uint8_t id, int32_t val)
+        {
+            // cmp dword [rdi + id * 4], val
+            _bytes({0x81, 0xbf});
+            _int(id * 4);
+            _int(val);
+        }
+
+        void compareWithLocal(uint8_t id)
+        {
+            // cmp eax, [rdi + id * 4]
+            _bytes({0x3b, 0x87});
+            _int(id * 4);
+        }
+
+        /**
+         * @brief Apply binary operation `eax = eax op ecx`
+         *
+         * @param opcode Opcode of the `op r/m32, r32` form of the operation
+         */
+        void binary(uint8_t opcode) { _bytes({opcode, 0xc8}); }
+
+        /**
+         * @brief Compare eax with ecx and store result of the condition in eax as 0 or 1
+         *
+         * @param setcc Second byte of the setcc instruction for the condition
+         */
+        void compare(uint8_t setcc)
+        {
+            // cmp eax, ecx; setcc al; movzx eax, al
+            _bytes({0x39, 0xc8, 0x0f, setcc, 0xc0, 0x0f, 0xb6, 0xc0});
+        }
+
+        /**
+         * @brief Load budget into rdx, where it's kept while native code runs
+         *
+         */
+        void loadBudget() { _bytes({0x48, 0x8b, 0x16}); }
+
+        void chargeBudget(int32_t cost)
+        {
+            // sub rdx, cost
+            _bytes({0x48, 0x81, 0xea});
+            _int(cost);
+        }
+
+        void notEax() { _bytes({0x83, 0xf0, 0x01}); }
+
+        void negEax() { _bytes({0xf7, 0xd8}); }
+
+        void testEax() { _bytes({0x85, 0xc0}); }
+
+        /**
+         * @brief Emit jump with a 32 bit relative offset that must be filled in later using `patch`
+         *
+         * @param cc Second byte of the conditional jump or 0 for unconditional jump
+         * @return size_t Position of the offset
+         */
+        size_t jump(uint8_t cc)
+        {
+            if (cc == 0)
+            {
+                _byte(0xe9);
+            }
+            else
+            {
+                _bytes({0x0f, cc});
+            }
+            size_t at = m_code.size();
+            _int(0);
+            return at;
+        }
+
+        void patch(size_t at, size_t target)
+        {
+            int32_t offset = (int32_t)target - (int32_t)(at + 4);
+            std::memcpy(&m_code[at], &offset, sizeof(offset));
+        }
+
+        void exit(uint32_t id)
+        {
+            // mov [rsi], rdx; mov eax, id; ret
+            _bytes({0x48, 0x89, 0x16});
+            _byte(0xb8);
+            _int((int32_t)id);
+            _byte(0xc3);
+        }
+
+    private:
+        /**
+         * @brief Remove `push rax` if it was the last emitted instruction, since value is still in rax
+         *
+         */
+        bool _removePushRax()
+        {
+            if (m_pushRaxEnd != m_code.size())
+            {
+                return false;
+            }
+            m_code.pop_back();
+            m_pushRaxEnd = 0;
+            return true;
+        }
+
+        void _byte(uint8_t b) { m_code.push_back(b); }
+
+        void _bytes(std::initializer_list<uint8_t> bytes) { m_code.insert(m_code.end(), bytes); }
+
+        void _int(int32_t val)
+        {
+            uint8_t bytes[sizeof(val)];
+            std::memcpy(bytes, &val, sizeof(val));
+            m_code.insert(m_code.end(), bytes, bytes + sizeof(val));
+        }
+
+        std::vector<uint8_t> m_code;
+        size_t m_pushRaxEnd = 0;
+    };
+
+    constexpr uint8_t OpcodeAdd = 0x01;
+    constexpr uint8_t OpcodeSub = 0x29;
+    constexpr uint8_t OpcodeAnd = 0x21;
+    constexpr uint8_t OpcodeOr = 0x09;
+
+    constexpr uint8_t SetEqual = 0x94;
+    constexpr uint8_t SetNotEqual = 0x95;
+    constexpr uint8_t SetLess = 0x9c;
+    constexpr uint8_t SetMoreOrEq = 0x9d;
+    constexpr uint8_t SetLessOrEq = 0x9e;
+    constexpr uint8_t SetMore = 0x9f;
+
+    constexpr uint8_t JumpIfZero = 0x84;
+    constexpr uint8_t JumpIfNotLess = 0x8d;
+    constexpr uint8_t JumpIfLessOrEq = 0x8e;
+    constexpr uint8_t JumpIfMore = 0x8f;
+}
+
+GobLang::JitLoop::JitLoop(std::vector<Instruction> const &instructions, size_t head, size_t back, std::vector<MemoryValue> const &variables, size_t localCount)
+{
+#ifdef GOB_JIT_AVAILABLE
+    _compile(instructions, head, back, variables, localCount);
+#endif
+}
+
+bool GobLang::JitLoop::run(std::vector<MemoryValue> &variables, size_t &localCount, int64_t &budget, size_t &resumeAt)
+{
+    if (m_code == nullptr || localCount != m_localCount)
+    {
+        return false;
+    }
+    // guarded locals are a subset of touched ones
+    for (size_t i = 0; i < m_touchedEnd; i++)
+    {
+        if (m_guardedLocals[i] && variables[i].getType() != Type::Int)
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < m_touchedEnd; i++)
+    {
+        if (m_guardedLocals[i])
+        {
+            m_locals[i] = variables[i].getInt();
+        }
+    }
+    Exit const &exit = m_exits[((NativeFunction)m_code)(m_locals.data(), &budget)];
+    for (size_t i = 0; i < m_touchedEnd; i++)
+    {
+        if (!m_touchedLocals[i])
+        {
+            continue;
+        }
+        if (i >= variables.size())
+        {
+            variables.resize(i + 1);
+        }
+        // locals that were freed by the loop must be null, same as after `ShrinkLocal` in the interpreter
+        if (i < exit.localCount && exit.intLocals[i])
+        {
+            variables[i] = MemoryValue::makeInt(m_locals[i]);
+        }
+        else
+        {
+            variables[i] = MemoryValue::makeNull();
+        }
+    }
+    localCount = exit.localCount;
+    resumeAt = exit.resumeAt;
+    return true;
+}
+
+void GobLang::JitLoop::_compile(std::vector<Instruction> const &instructions, size_t head, size_t back, std::vector<MemoryValue> const &variables, size_t localCount)
+{
+    // split loop into statements, which are sequences that start and end with empty operation stack.
+    // Control can only leave native code at statement boundaries because operation stack doesn't have to be restored then
+    std::vector<size_t> statementEnd(back + 1, 0);
+    std::vector<bool> isStatementStart(back + 1, false);
+    LocalSet referencedLocals;
+    int32_t depth = 0;
+    size_t start = head;
+    for (size_t i = head; i <= back; i++)
+    {
+        Instruction const &instr = instructions[i];
+        if (isRegisterOperation(instr.op))
+        {
+            return;
+        }
+        int32_t pop, push;
+        getStackEffect(instr, pop, push);
+        if (depth == 0)
+        {
+            start = i;
+            isStatementStart[i] = true;
+        }
+        depth += push - pop;
+        if (depth < 0)
+        {
+            return;
+        }
+        bool isJump = getOperationData(instr.op)->isJump;
+        if (isJump && depth != 0)
+        {
+            return;
+        }
+        if (instr.op == Operation::Jump)
+        {
+            // next operation can only be reached by jumping to it, which always happens with an empty stack
+            depth = 0;
+        }
+        if (depth == 0)
+        {
+            statementEnd[start] = i + 1;
+        }
+        switch (instr.op)
+        {
+        case Operation::JumpIfLocalNotLessLocal:
+        case Operation::GetLocalArrayItem:
+            referencedLocals.set(instr.b);
+            [[fallthrough]];
+        case Operation::GetLocal:
+        case Operation::SetLocal:
+        case Operation::IncLocalByConst:
+        case Operation::DecLocalByConst:
+        case Operation::JumpIfLocalNotLessConst:
+            referencedLocals.set(instr.a);
+            break;
+        default:
+            break;
+        }
+    }
+    if (depth != 0)
+    {
+        return;
+    }
+    for (size_t i = head; i <= back; i++)
+    {
+        if (getOperationData(instructions[i].op)->isJump)
+        {
+            size_t target = instructions[i].target;
+            if (target >= head && target <= back && !isStatementStart[target])
+            {
+                return;
+            }
+        }
+    }
+
+    m_localCount = localCount;
+    for (size_t i = 0; i < localCount && i < variables.size(); i++)
+    {
+        if (referencedLocals[i] && variables[i].getType() == Type::Int)
+        {
+            m_guardedLocals.set(i);
+        }
+    }
+
+    struct State
+    {
+        bool reached = false;
+        size_t localCount = 0;
+        LocalSet intLocals;
+    };
+
+    /**
+     * @brief Where control goes after a statement
+     *
+     */
+    struct Successor
+    {
+        size_t target;
+        /**
+         * @brief Index of the instruction that transfers control
+         *
+         */
+        size_t source;
+        State state;
+        /**
+         * @brief Control goes to the target only once the budget runs out
+         *
+         */
+        bool budgetExit = false;
+        /**
+         * @brief Budget was already charged for this backward jump
+         *
+         */
+        bool charged = false;
+    };
+
+    // checks if statement can be compiled using given state and generates code for it if assembler is provided.
+    // Returns false if statement uses anything that can't be compiled
+    auto processStatement = [&](size_t statement, State state, Assembler *as, std::vector<Successor> &successors, std::vector<size_t> &jumps, LocalSet &written) -> bool
+    {
+        std::vector<JitType> stack;
+        auto isIntLocal = [&state](uint8_t id)
+        { return id < state.localCount && state.intLocals[id]; };
+        auto popType = [&stack](JitType type) -> bool
+        {
+            if (stack.empty() || stack.back() != type)
+            {
+                return false;
+            }
+            stack.pop_back();
+            return true;
+        };
+        size_t end = statementEnd[statement];
+        for (size_t i = statement; i < end; i++)
+        {
+            Instruction const &instr = instructions[i];
+            switch (instr.op)
+            {
+            case Operation::None:
+                break;
+            case Operation::GetLocal:
+                if (!isIntLocal(instr.a))
+                {
+                    return false;
+                }
+                stack.push_back(JitType::Int);
+                if (as)
+                {
+                    as->loadLocal(instr.a);
+                    as->pushRax();
+                }
+                break;
+            case Operation::SetLocal:
+                if (!popType(JitType::Int) || (instr.a < state.localCount && !state.intLocals[instr.a]))
+                {
+                    return false;
+                }
+                if (instr.a >= state.localCount)
+                {
+                    state.localCount = instr.a + 1;
+                }
+                state.intLocals.set(instr.a);
+                written.set(instr.a);
+                if (as)
+                {
+                    as->popRax();
+                    as->storeLocal(instr.a);
+                }
+                break;
+            case Operation::PushConstInt:
+                stack.push_back(JitType::Int);
+                if (as)
+                {
+                    as->pushImm(instr.value);
+                }
+                break;
+            case Operation::PushTrue:
+            case Operation::PushFalse:
+                stack.push_back(JitType::Bool);
+                if (as)
+                {
+                    as->pushImm(instr.op == Operation::PushTrue ? 1 : 0);
+                }
+                break;
+            case Operation::Add:
+            case Operation::AddIntInt:
+            case Operation::Sub:
+            case Operation::Less:
+            case Operation::LessIntInt:
+            case Operation::More:
+            case Operation::LessOrEq:
+            case Operation::MoreOrEq:
+            {
+                if (!popType(JitType::Int) || !popType(JitType::Int))
+                {
+                    return false;
+                }
+                bool isArithmetic = instr.op == Operation::Add || instr.op == Operation::AddIntInt || instr.op == Operation::Sub;
+                stack.push_back(isArithmetic ? JitType::Int : JitType::Bool);
+                if (as)
+                {
+                    as->popRcx();
+                    as->popRax();
+                    switch (instr.op)
+                    {
+                    case Operation::Add:
+                    case Operation::AddIntInt:
+                        as->binary(OpcodeAdd);
+                        break;
+                    case Operation::Sub:
+                        as->binary(OpcodeSub);
+                        break;
+                    case Operation::Less:
+                    case Operation::LessIntInt:
+                        as->compare(SetLess);
+                        break;
+                    case Operation::More:
+                        as->compare(SetMore);
+                        break;
+                    case Operation::LessOrEq:
+                        as->compare(SetLessOrEq);
+                        break;
+                    default:
+                        as->compare(SetMoreOrEq);
+                        break;
+                    }
+                    as->pushRax();
+                }
+                break;
+            }
+            case Operation::Equals:
+            case Operation::NotEq:
+            {
+                if (stack.size() < 2 || stack[stack.size() - 1] != stack[stack.size() - 2])
+                {
+                    return false;
+                }
+                stack.pop_back();
+                stack.back() = JitType::Bool;
+                if (as)
+                {
+                    as->popRcx();
+                    as->popRax();
+                    as->compare(instr.op == Operation::Equals ? SetEqual : SetNotEqual);
+                    as->pushRax();
+                }
+                break;
+            }
+            case Operation::And:
+            case Operation::Or:
+                if (!popType(JitType::Bool) || !popType(JitType::Bool))
+                {
+                    return false;
+                }
+                stack.push_back(JitType::Bool);
+                if (as)
+                {
+                    as->popRcx();
+                    as->popRax();
+                    as->binary(instr.op == Operation::And ? OpcodeAnd : OpcodeOr);
+                    as->pushRax();
+                }
+                break;
+            case Operation::Not:
+            case Operation::Negate:
+            {
+                JitType type = instr.op == Operation::Not ? JitType::Bool : JitType::Int;
+                if (!popType(type))
+                {
+                    return false;
+                }
+                stack.push_back(type);
+                if (as)
+                {
+                    as->popRax();
+                    if (instr.op == Operation::Not)
+                    {
+                        as->notEax();
+                    }
+                    else
+                    {
+                        as->negEax();
+                    }
+                    as->pushRax();
+                }
+                break;
+            }
+            case Operation::Pop:
+                if (stack.empty())
+                {
+                    return false;
+                }
+                stack.pop_back();
+                if (as)
+                {
+                    as->popRax();
+                }
+                break;
+            case Operation::IncLocalByConst:
+            case Operation::DecLocalByConst:
+                if (!isIntLocal(instr.a))
+                {
+                    return false;
+                }
+                written.set(instr.a);
+                if (as)
+                {
+                    if (instr.op == Operation::IncLocalByConst)
+                    {
+                        as->addToLocal(instr.a, instr.value);
+                    }
+                    else
+                    {
+                        as->subFromLocal(instr.a, instr.value);
+                    }
+                }
+                break;
+            case Operation::ShrinkLocal:
+            {
+                size_t newCount = instr.a > state.localCount ? 0 : state.localCount - instr.a;
+                for (size_t id = newCount; id < state.localCount; id++)
+                {
+                    // non integer values might need their reference counts updated, which only interpreter can do
+                    if (!state.intLocals[id])
+                    {
+                        return false;
+                    }
+                    state.intLocals.reset(id);
+                }
+                state.localCount = newCount;
+                break;
+            }
+            case Operation::Jump:
+                if (instr.target >= head && instr.target <= i)
+                {
+                    // loop back edge charges the budget in place and only jumps back while there is budget left,
+                    // otherwise it falls through to the exit
+                    successors.push_back(Successor{.target = instr.target, .source = i, .state = state, .charged = true});
+                    successors.push_back(Successor{.target = instr.target, .source = i, .state = state, .budgetExit = true});
+                    if (as)
+                    {
+                        as->chargeBudget((int32_t)(i - instr.target + 1));
+                        jumps.push_back(as->jump(JumpIfMore));
+                        jumps.push_back(as->jump(0));
+                    }
+                    return true;
+                }
+                successors.push_back(Successor{.target = instr.target, .source = i, .state = state});
+                if (as)
+                {
+                    jumps.push_back(as->jump(0));
+                }
+                return true;
+            case Operation::JumpIfNot:
+                if (!popType(JitType::Bool))
+                {
+                    return false;
+                }
+                successors.push_back(Successor{.target = instr.target, .source = i, .state = state});
+                if (as)
+                {
+                    as->popRax();
+                    as->testEax();
+                    jumps.push_back(as->jump(JumpIfZero));
+                }
+                break;
+            case Operation::JumpIfLocalNotLessLocal:
+                if (!isIntLocal(instr.a) || !isIntLocal(instr.b))
+                {
+                    return false;
+                }
+                successors.push_back(Successor{.target = instr.target, .source = i, .state = state});
+                if (as)
+                {
+                    as->loadLocal(instr.a);
+                    as->compareWithLocal(instr.b);
+                    jumps.push_back(as->jump(JumpIfNotLess));
+                }
+                break;
+            case Operation::JumpIfLocalNotLessConst:
+                if (!isIntLocal(instr.a))
+                {
+                    return false;
+                }
+                successors.push_back(Successor{.target = instr.target, .source = i, .state = state});
+                if (as)
+                {
+                    as->compareLocalWithConst(instr.a, instr.value);
+                    jumps.push_back(as->jump(JumpIfNotLess));
+                }
+                break;
+            default:
+                return false;
+            }
+        }
+        successors.push_back(Successor{.target = end, .source = end - 1, .state = state});
+        return true;
+    };
+
+    // find state of local variables at the start of every reachable statement
+    std::vector<State> states(back + 1);
+    states[head] = State{.reached = true, .localCount = localCount, .intLocals = m_guardedLocals};
+    std::vector<size_t> pending = {head};
+    while (!pending.empty())
+    {
+        size_t statement = pending.back();
+        pending.pop_back();
+        std::vector<Successor> successors;
+        std::vector<size_t> jumps;
+        LocalSet written;
+        if (!processStatement(statement, states[statement], nullptr, successors, jumps, written))
+        {
+            if (statement == head)
+            {
+                return;
+            }
+            continue;
+        }
+        for (Successor const &succ : successors)
+        {
+            if (succ.target < head || succ.target > back)
+            {
+                continue;
+            }
+            State &target = states[succ.target];
+            if (!target.reached)
+            {
+                target = succ.state;
+                pending.push_back(succ.target);
+            }
+            else if (target.localCount != succ.state.localCount)
+            {
+                // structured code always has the same amount of variables at the same place
+                return;
+            }
+            else if ((target.intLocals & succ.state.intLocals) != target.intLocals)
+            {
+                target.intLocals &= succ.state.intLocals;
+                pending.push_back(succ.target);
+            }
+        }
+    }
+
+    Assembler as;
+    std::map<size_t, size_t> labels;
+    // positions of jump offsets and instructions they jump to
+    std::vector<std::pair<size_t, size_t>> localJumps;
+    std::vector<std::pair<size_t, uint32_t>> exitJumps;
+    // backward jumps are safepoints, they go through code that charges the budget and leaves native code once it runs out
+    struct BackwardJump
+    {
+        size_t at;
+        size_t target;
+        int32_t cost;
+        uint32_t exit;
+    };
+    std::vector<BackwardJump> backwardJumps;
+    m_touchedLocals = m_guardedLocals;
+    as.loadBudget();
+    for (size_t statement = head; statement <= back; statement = statementEnd[statement])
+    {
+        State const &state = states[statement];
+        if (!state.reached)
+        {
+            continue;
+        }
+        labels[statement] = as.size();
+        std::vector<Successor> successors;
+        std::vector<size_t> jumps;
+        LocalSet written;
+        // statement is checked before generating code, otherwise part of it would be left in the code
+        if (!processStatement(statement, state, nullptr, successors, jumps, written))
+        {
+            // code after the unsupported statement is not generated, so the statement can be safely restarted in the interpreter
+            m_exits.push_back(Exit{.resumeAt = statement, .localCount = state.localCount, .intLocals = state.intLocals});
+            as.exit(m_exits.size() - 1);
+            continue;
+        }
+        successors.clear();
+        processStatement(statement, state, &as, successors, jumps, written);
+        m_touchedLocals |= written;
+        for (size_t i = 0; i < jumps.size(); i++)
+        {
+            Successor const &succ = successors[i];
+            if (succ.budgetExit)
+            {
+                m_exits.push_back(Exit{.resumeAt = succ.target, .localCount = succ.state.localCount, .intLocals = succ.state.intLocals});
+                exitJumps.push_back({jumps[i], m_exits.size() - 1});
+            }
+            else if (succ.target >= head && succ.target <= succ.source && !succ.charged)
+            {
+                m_exits.push_back(Exit{.resumeAt = succ.target, .localCount = succ.state.localCount, .intLocals = succ.state.intLocals});
+                backwardJumps.push_back(BackwardJump{.at = jumps[i], .target = succ.target, .cost = (int32_t)(succ.source - succ.target + 1), .exit = (uint32_t)m_exits.size() - 1});
+            }
+            else if (succ.target >= head && succ.target <= back)
+            {
+                localJumps.push_back({jumps[i], succ.target});
+            }
+            else
+            {
+                m_exits.push_back(Exit{.resumeAt = succ.target, .localCount = succ.state.localCount, .intLocals = succ.state.intLocals});
+                exitJumps.push_back({jumps[i], m_exits.size() - 1});
+            }
+        }
+    }
+    for (std::pair<size_t, size_t> const &jump : localJumps)
+    {
+        as.patch(jump.first, labels.at(jump.second));
+    }
+    for (std::pair<size_t, uint32_t> const &jump : exitJumps)
+    {
+        as.patch(jump.first, as.size());
+        as.exit(jump.second);
+    }
+    for (BackwardJump const &jump : backwardJumps)
+    {
+        as.patch(jump.at, as.size());
+        as.chargeBudget(jump.cost);
+        size_t exhausted = as.jump(JumpIfLessOrEq);
+        as.patch(as.jump(0), labels.at(jump.target));
+        as.patch(exhausted, as.size());
+        as.exit(jump.exit);
+    }
+    for (size_t i = 0; i < m_touchedLocals.size(); i++)
+    {
+        if (m_touchedLocals[i])
+        {
+            m_touchedEnd = i + 1;
+        }
+    }
+    _install(as.getCode());
+}
+
+void GobLang::JitLoop::_install(std::vector<uint8_t> const &code)
+{
+#ifdef GOB_JIT_AVAILABLE
+    void *mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+    {
+        return;
+    }
+    std::memcpy(mem, code.data(), code.size());
+    if (mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(mem, code.size());
+        return;
+    }
+    m_code = mem;
+    m_codeSize = code.size();
+#endif
+}
+
+GobLang::JitLoop::~JitLoop()
+{
+#ifdef GOB_JIT_AVAILABLE
+    if (m_code != nullptr)
+    {
+        munmap(m_code, m_codeSize);
+    }
+#endif
+}
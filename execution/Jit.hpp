@@ -0,0 +1,121 @@
+#pragma once
+#include <vector>
+#include <bitset>
+#include <cstdint>
+#include <cstddef>
+
+#include "Operations.hpp"
+#include "Value.hpp"
+
+#if defined(GOB_JIT) && defined(__x86_64__) && defined(__linux__)
+#define GOB_JIT_AVAILABLE
+#endif
+
+namespace GobLang
+{
+    /**
+     * @brief Loop compiled into native code. Covers instructions between the target of a backward jump and the jump itself.
+     * Only integer and boolean operations on local variables are compiled, any statement that uses something else
+     * leaves native code and lets the interpreter continue from the start of that statement
+     *
+     */
+    class JitLoop
+    {
+    public:
+        /**
+         * @brief Try to compile the loop
+         *
+         * @param instructions All instructions of the program
+         * @param head Index of the first instruction of the loop
+         * @param back Index of the backward jump that closes the loop
+         * @param variables Current values of local variables, used to decide which locals can be treated as integers
+         * @param localCount Current amount of alive local variables. Loop will only be entered with the same amount of local variables
+         */
+        explicit JitLoop(std::vector<Instruction> const &instructions, size_t head, size_t back, std::vector<MemoryValue> const &variables, size_t localCount);
+
+        /**
+         * @brief Was loop successfully compiled into native code
+         *
+         */
+        bool isCompiled() const { return m_code != nullptr; }
+
+        /**
+         * @brief Run native code of the loop starting at the first instruction of the loop
+         *
+         * @param variables Local variables of the machine. Integer values are read before and written back after native code finishes
+         * @param localCount Amount of alive local variables, updated if native code declared or freed variables
+         * @param budget Execution budget, every backward jump takes the length of the loop out of it and native code returns once it runs out
+         * @param resumeAt Index of the instruction that interpreter should continue from
+         * @return true Native code was executed
+         * @return false Current state of variables doesn't match the state code was compiled for, nothing was executed
+         */
+        bool run(std::vector<MemoryValue> &variables, size_t &localCount, int64_t &budget, size_t &resumeAt);
+
+        ~JitLoop();
+
+    private:
+        using LocalSet = std::bitset<256>;
+        using NativeFunction = uint32_t (*)(int32_t *locals, int64_t *budget);
+
+        /**
+         * @brief Place where native code returns control to the interpreter
+         *
+         */
+        struct Exit
+        {
+            /**
+             * @brief Instruction the interpreter continues from
+             *
+             */
+            size_t resumeAt;
+            /**
+             * @brief Amount of alive local variables at this point
+             *
+             */
+            size_t localCount;
+            /**
+             * @brief Local variables that contain integers at this point
+             *
+             */
+            LocalSet intLocals;
+        };
+
+        void _compile(std::vector<Instruction> const &instructions, size_t head, size_t back, std::vector<MemoryValue> const &variables, size_t localCount);
+
+        /**
+         * @brief Copy generated machine code into executable memory
+         *
+         * @param code Machine code
+         */
+        void _install(std::vector<uint8_t> const &code);
+
+        void *m_code = nullptr;
+        size_t m_codeSize = 0;
+        /**
+         * @brief Amount of alive local variables that the loop was compiled for
+         *
+         */
+        size_t m_localCount = 0;
+        /**
+         * @brief Local variables that must contain integers when entering the loop
+         *
+         */
+        LocalSet m_guardedLocals;
+        /**
+         * @brief Local variables that native code reads or writes
+         *
+         */
+        LocalSet m_touchedLocals;
+        /**
+         * @brief Id after the last touched local variable, so entering the loop doesn't have to scan the whole set
+         *
+         */
+        size_t m_touchedEnd = 0;
+        std::vector<Exit> m_exits;
+        /**
+         * @brief Unboxed values of local variables used by native code
+         *
+         */
+        std::vector<int32_t> m_locals = std::vector<int32_t>(256);
+    };
+}
@@ -1,697 +1,2101 @@
 #include "Machine.hpp"
+#include "Verifier.hpp"
 #include <iostream>
 #include <vector>
-GobLang::Machine::Machine(Compiler::ByteCode const &code)
+#include <algorithm>
+GobLang::Machine::Machine(Compiler::ByteCode const &code, NativeRegistry const &natives, GarbageCollectorMode gcMode) : m_gcMode(gcMode)
 {
     m_constInts = code.ints;
     m_constStrings = code.ids;
+    m_constNatives = code.natives;
+    m_natives = natives;
+    for (size_t i = 0; i < m_natives.getCount(); i++)
+    {
+        m_globals[m_natives.get(i).name] = MemoryValue::makeNativeFunction(i);
+    }
+    _bindNatives();
     m_operations = code.operations;
+    m_registerBase = code.localCount;
+    if (code.registerCount > 0)
+    {
+        m_variables.resize(code.registerCount);
+    }
+    // programs that fail verification are rejected at load time instead of once they reach the broken code
+    _prepareOperations();
 }
 void GobLang::Machine::addFunction(FunctionValue const &func, std::string const &name)
 
 {
-    m_globals[name] = MemoryValue{.type = Type::NativeFunction, .value = func};
+    m_functionObjects.push_back(func);
+    addNativeFunction(_callFunctionObject, name, &m_functionObjects.back());
+}
+
+void GobLang::Machine::addNativeFunction(NativeFunctionPointer func, std::string const &name, void *userData)
+{
+    m_globals[name] = MemoryValue::makeNativeFunction(m_natives.add(name, func, userData));
+    _bindNatives();
+}
+
+void GobLang::Machine::_callFunctionObject(Machine *machine, NativeArguments const &args, void *userData)
+{
+    (*static_cast<FunctionValue *>(userData))(machine, args);
+}
+
+void GobLang::Machine::_bindNatives()
+{
+    m_nativeBindings.resize(m_constNatives.size());
+    for (size_t i = 0; i < m_constNatives.size(); i++)
+    {
+        m_nativeBindings[i] = m_natives.find(m_constNatives[i]);
+    }
+}
+
+size_t GobLang::Machine::_getBoundNative(size_t id) const
+{
+    if (m_nativeBindings[id] == -1)
+    {
+        throw RuntimeException(std::string("Attempted to call native function '") + m_constNatives[id] + "', which doesn't exist");
+    }
+    return m_nativeBindings[id];
 }
 void GobLang::Machine::step()
 {
-    if (m_programCounter >= m_operations.size())
+    _prepareOperations();
+    if (isAtTheEnd())
     {
         return;
     }
-    switch ((Operation)m_operations[m_programCounter])
+    _reserveOperationStack();
+    _execute<true>(INT64_MAX);
+}
+
+void GobLang::Machine::run()
+{
+    _prepareOperations();
+    if (isAtTheEnd())
     {
-    case Operation::Add:
-        _addInt();
-        break;
-    case Operation::Sub:
-        _subInt();
-        break;
-    case Operation::Call:
-        _call();
-        break;
-    case Operation::Set:
-        _set();
-        collectGarbage();
-        break;
-    case Operation::Get:
-        _get();
-        break;
-    case Operation::GetLocal:
-        _getLocal();
-        break;
-    case Operation::SetLocal:
-        _setLocal();
-        collectGarbage();
-        break;
-    case Operation::PushConstInt:
-        _pushConstInt();
-        break;
-    case Operation::PushConstChar:
-        _pushConstChar();
-        break;
-    case Operation::PushConstString:
-        _pushConstString();
-        break;
-    case Operation::GetArray:
-        _getArray();
-        break;
-    case Operation::SetArray:
-        _setArray();
-        collectGarbage();
-        break;
-    case Operation::Jump:
-        _jump();
-        return; // this uses return because we want to avoid advancing the counter after jup
-    case Operation::JumpIfNot:
-        _jumpIf();
         return;
-    case Operation::PushTrue:
-        m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = true});
-        break;
-    case Operation::PushFalse:
-        m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = false});
-        break;
-    case Operation::Equals:
-        _eq();
-        break;
-    case Operation::NotEq:
-        _neq();
-        break;
-    case Operation::Less:
-        _less();
-        break;
-    case Operation::More:
-        _more();
-        break;
-    case Operation::Not:
-        _not();
-        break;
-    case Operation::And:
-        _and();
-        break;
-    case Operation::Or:
-        _or();
-        break;
-    case Operation::LessOrEq:
-        _lessOrEq();
-        break;
-    case Operation::MoreOrEq:
-        _moreOrEq();
-        break;
-    case Operation::Negate:
-        _negate();
-        break;
-    case Operation::ShrinkLocal:
-        _shrink();
-        collectGarbage();
-        break;
-    case Operation::End:
-        m_forcedEnd = true;
-        break;
-    default:
-        std::cerr << "Invalid op code: " << (int32_t)m_operations[m_programCounter] << std::endl;
-        break;
     }
-    m_programCounter++;
+    _reserveOperationStack();
+    _execute<false>(INT64_MAX);
+}
+
+GobLang::RunStatus GobLang::Machine::run(size_t budget)
+{
+    if (m_failed)
+    {
+        return RunStatus::Error;
+    }
+    try
+    {
+        _prepareOperations();
+        if (isAtTheEnd())
+        {
+            return RunStatus::Finished;
+        }
+        _reserveOperationStack();
+        return _execute<false>(budget > INT64_MAX ? INT64_MAX : (int64_t)budget);
+    }
+    catch (std::exception const &e)
+    {
+        m_failed = true;
+        m_errorMessage = e.what();
+        return RunStatus::Error;
+    }
+}
+
+#if defined(GOB_COMPUTED_GOTO) && (defined(__GNUC__) || defined(__clang__))
+#define GOB_THREADED_DISPATCH
+#endif
+
+#ifdef GOB_THREADED_DISPATCH
+#define GOB_OP(name) op_##name
+#define GOB_DISPATCH() goto *dispatchTable[(uint8_t)ip->op]
+#else
+#define GOB_OP(name) case Operation::name
+#define GOB_DISPATCH() goto dispatch
+#endif
+
+/**
+ * @brief Move on to the next instruction
+ */
+#define GOB_NEXT()                \
+    do                            \
+    {                             \
+        ip++;                     \
+        if constexpr (SingleStep) \
+        {                         \
+            goto finish;          \
+        }                         \
+        GOB_DISPATCH();           \
+    } while (0)
+
+/**
+ * @brief Move on to the instruction that is the target of the current jump instruction
+ */
+#define GOB_JUMP()                          \
+    do                                      \
+    {                                       \
+        Instruction *from = ip;             \
+        ip = instructions + ip->target;     \
+        if (ip <= from)                     \
+        {                                   \
+            GOB_SAFEPOINT(from - ip + 1);   \
+        }                                   \
+        if constexpr (SingleStep)           \
+        {                                   \
+            goto finish;                    \
+        }                                   \
+        GOB_DISPATCH();                     \
+    } while (0)
+
+/**
+ * @brief Move on to the next instruction after a function call, calls are safepoints
+ */
+#define GOB_NEXT_AFTER_CALL()     \
+    do                            \
+    {                             \
+        ip++;                     \
+        GOB_SAFEPOINT(1);         \
+        if constexpr (SingleStep) \
+        {                         \
+            goto finish;          \
+        }                         \
+        GOB_DISPATCH();           \
+    } while (0)
+
+/**
+ * @brief Take the cost out of the budget and stop once budget runs out. Only backward jumps and calls are safepoints,
+ * which keeps the check out of straight line code. Execution resumes from the instruction `ip` points to
+ */
+#define GOB_SAFEPOINT(cost)                         \
+    do                                              \
+    {                                               \
+        budget -= (int64_t)(cost);                  \
+        if (budget <= 0)                            \
+        {                                           \
+            status = RunStatus::BudgetExhausted;    \
+            goto finish;                            \
+        }                                           \
+    } while (0)
+
+/**
+ * @brief Replace quickened operation with its generic version and execute it, used when operand types no longer match the specialization
+ */
+#define GOB_DEOPTIMIZE(generic)       \
+    do                                \
+    {                                 \
+        ip->op = Operation::generic;  \
+        GOB_DISPATCH();               \
+    } while (0)
+
+#ifdef GOB_TOS_CACHE
+/**
+ * @brief Top of the operation stack lives in the `tos` local, `sp` points at the slot it would be stored in.
+ * When stack is empty `sp` points at the reserved slot before the stack base, so spilling never has to check the depth
+ */
+#define GOB_TOP tos
+#define GOB_SECOND sp[-1]
+
+#define GOB_SAVE_STATE()                                 \
+    do                                                   \
+    {                                                    \
+        m_programCounter = ip - instructions;            \
+        *sp = tos;                                       \
+        m_operationStackSize = sp - stackBase + 1;       \
+    } while (0)
+
+#define GOB_LOAD_STATE()                                    \
+    do                                                      \
+    {                                                       \
+        ip = instructions + m_programCounter;               \
+        stackBase = _stackBase();                           \
+        sp = stackBase + m_operationStackSize - 1;          \
+        tos = *sp;                                          \
+    } while (0)
+
+/**
+ * @brief Push value without checking the stack size, verifier guarantees that the stack has enough space
+ */
+#define GOB_PUSH(val)     \
+    do                    \
+    {                     \
+        *sp++ = tos;      \
+        tos = (val);      \
+    } while (0)
+
+#define GOB_POP() tos = *--sp
+#else
+#define GOB_TOP sp[-1]
+#define GOB_SECOND sp[-2]
+
+#define GOB_SAVE_STATE()                          \
+    do                                            \
+    {                                             \
+        m_programCounter = ip - instructions;     \
+        m_operationStackSize = sp - stackBase;    \
+    } while (0)
+
+#define GOB_LOAD_STATE()                                    \
+    do                                                      \
+    {                                                       \
+        ip = instructions + m_programCounter;               \
+        stackBase = _stackBase();                           \
+        sp = stackBase + m_operationStackSize;              \
+    } while (0)
+
+/**
+ * @brief Push value without checking the stack size, verifier guarantees that the stack has enough space
+ */
+#define GOB_PUSH(val) *sp++ = (val)
+
+#define GOB_POP() sp--
+#endif
+
+/**
+ * @brief Replace two values on top of the stack with the result of the binary operation
+ */
+#define GOB_BINARY_RESULT(val)                 \
+    do                                         \
+    {                                          \
+        MemoryValue gobResult = (val);         \
+        sp--;                                  \
+        GOB_TOP = gobResult;                   \
+    } while (0)
+
+/**
+ * @brief Run a handler implemented as a member function, which uses the machine state instead of the locals
+ */
+#define GOB_CALL_HANDLER(handler) \
+    do                            \
+    {                             \
+        GOB_SAVE_STATE();         \
+        handler;                  \
+        GOB_LOAD_STATE();         \
+    } while (0)
+
+// collection needs to see the whole operation stack, so the state is only saved when it actually runs
+#define GOB_COLLECT_GARBAGE()                              \
+    do                                                     \
+    {                                                      \
+        if (_isCollectionNeeded())                         \
+        {                                                  \
+            GOB_CALL_HANDLER(_collectGarbageAtSafepoint()); \
+        }                                                  \
+    } while (0)
+
+#define GOB_NUMERIC_COMPARE(cmp, a, b)                                                                                                                   \
+    do                                                                                                                                                   \
+    {                                                                                                                                                    \
+        if ((a).getType() != (b).getType())                                                                                                              \
+        {                                                                                                                                                \
+            throw RuntimeException(std::string("Attempted to compare value of ") + typeToString((a).getType()) + " and " + typeToString((b).getType())); \
+        }                                                                                                                                                \
+        switch ((a).getType())                                                                                                                           \
+        {                                                                                                                                                \
+        case Type::Int:                                                                                                                                  \
+            (a) = MemoryValue::makeBool((a).getInt() cmp (b).getInt());                                                                                  \
+            break;                                                                                                                                       \
+        case Type::Number:                                                                                                                               \
+            (a) = MemoryValue::makeBool((a).getNumber() cmp (b).getNumber());                                                                            \
+            break;                                                                                                                                       \
+        default:                                                                                                                                         \
+            throw RuntimeException(std::string("Attempted to compare value of type ") + typeToString((a).getType()) +                                    \
+                                   ". Only numeric types can be compared using >,<, <=, >=");                                                            \
+        }                                                                                                                                                \
+    } while (0)
+
+/**
+ * @brief Payload of the value is only valid for its type, so arithmetic checks both operands before reading them
+ */
+#define GOB_CHECK_INTEGERS(action, a, b)                                                                                                                     \
+    do                                                                                                                                                       \
+    {                                                                                                                                                        \
+        if ((a).getType() != Type::Int || (b).getType() != Type::Int)                                                                                        \
+        {                                                                                                                                                    \
+            throw RuntimeException(std::string("Attempted to " action " values of ") + typeToString((a).getType()) + " and " + typeToString((b).getType())); \
+        }                                                                                                                                                    \
+    } while (0)
+
+#define GOB_REGISTER(field) m_variables[ip->field]
+
+/**
+ * @brief Write value into the register. Registers that belong to local variables use reference counting, temporary ones are plain values.
+ * Local variables that are already alive and are not objects can be written directly as well, and so can any alive local variable in tracing mode,
+ * unless the value is a nursery string that has to be moved to the heap first
+ */
+#define GOB_SET_REGISTER(field, val)                                                                                                           \
+    do                                                                                                                                         \
+    {                                                                                                                                          \
+        uint8_t reg = ip->field;                                                                                                               \
+        MemoryValue &dest = m_variables[reg];                                                                                                  \
+        if (reg >= m_registerBase ||                                                                                                           \
+            (reg < m_localVariableCount &&                                                                                                     \
+             ((dest.getType() != Type::MemoryObj && (val).getType() != Type::MemoryObj) ||                                                     \
+              (m_gcMode != GarbageCollectorMode::ReferenceCounting && ((val).getType() != Type::MemoryObj || !m_nursery.contains((val).getObject())))))) \
+        {                                                                                                                                      \
+            dest = (val);                                                                                                                      \
+        }                                                                                                                                      \
+        else                                                                                                                                   \
+        {                                                                                                                                      \
+            setLocalVariableValue(reg, (val));                                                                                                 \
+        }                                                                                                                                      \
+    } while (0)
+
+template <bool SingleStep>
+GobLang::RunStatus GobLang::Machine::_execute(int64_t budget)
+{
+    RunStatus status = RunStatus::Finished;
+    // instructions are not constant because generic operations are replaced with quickened ones in place
+    Instruction *instructions = m_instructions.data();
+    Instruction *ip = instructions + m_programCounter;
+    MemoryValue *stackBase;
+    MemoryValue *sp;
+#ifdef GOB_TOS_CACHE
+    MemoryValue tos;
+#endif
+    GOB_LOAD_STATE();
+#ifdef GOB_THREADED_DISPATCH
+    // order must match the order of the Operation enum
+    static void *const dispatchTable[] = {
+        &&op_None,
+        &&op_Add,
+        &&op_Sub,
+        &&op_Call,
+        &&op_Set,
+        &&op_Get,
+        &&op_GetLocal,
+        &&op_SetLocal,
+        &&op_GetArray,
+        &&op_SetArray,
+        &&op_PushConstInt,
+        &&op_PushConstChar,
+        &&op_PushConstString,
+        &&op_PushTrue,
+        &&op_PushFalse,
+        &&op_Equals,
+        &&op_Less,
+        &&op_More,
+        &&op_LessOrEq,
+        &&op_MoreOrEq,
+        &&op_NotEq,
+        &&op_And,
+        &&op_Or,
+        &&op_Not,
+        &&op_Negate,
+        &&op_Jump,
+        &&op_JumpIfNot,
+        &&op_ShrinkLocal,
+        &&op_IncLocalByConst,
+        &&op_DecLocalByConst,
+        &&op_JumpIfLocalNotLessLocal,
+        &&op_JumpIfLocalNotLessConst,
+        &&op_GetLocalArrayItem,
+        &&op_GetGlobalConst,
+        &&op_Pop,
+        &&op_CallNative,
+        &&op_RegMove,
+        &&op_RegLoadInt,
+        &&op_RegLoadChar,
+        &&op_RegLoadBool,
+        &&op_RegLoadString,
+        &&op_RegGetGlobal,
+        &&op_RegSetGlobal,
+        &&op_RegAdd,
+        &&op_RegSub,
+        &&op_RegEquals,
+        &&op_RegNotEq,
+        &&op_RegLess,
+        &&op_RegMore,
+        &&op_RegLessOrEq,
+        &&op_RegMoreOrEq,
+        &&op_RegAnd,
+        &&op_RegOr,
+        &&op_RegNot,
+        &&op_RegNegate,
+        &&op_RegGetArray,
+        &&op_RegSetArray,
+        &&op_RegCall,
+        &&op_RegCallNative,
+        &&op_RegJumpIfNot,
+        &&op_AddIntInt,
+        &&op_LessIntInt,
+        &&op_EqChar,
+        &&op_GetArrayIndexInt,
+        &&op_End,
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) == (size_t)Operation::End + 1, "Dispatch table must cover every operation");
+#endif
+    try
+    {
+#ifdef GOB_THREADED_DISPATCH
+        GOB_DISPATCH();
+        {
+#else
+    dispatch:
+        switch (ip->op)
+        {
+#endif
+        GOB_OP(None):
+            GOB_NEXT();
+        GOB_OP(Add):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            GOB_CHECK_INTEGERS("add", a, b);
+            ip->op = Operation::AddIntInt;
+            GOB_BINARY_RESULT(MemoryValue::makeInt(a.getInt() + b.getInt()));
+            GOB_NEXT();
+        }
+        GOB_OP(Sub):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            GOB_CHECK_INTEGERS("subtract", a, b);
+            GOB_BINARY_RESULT(MemoryValue::makeInt(a.getInt() - b.getInt()));
+            GOB_NEXT();
+        }
+        GOB_OP(Call):
+            GOB_CALL_HANDLER(_call(ip->a));
+            GOB_NEXT_AFTER_CALL();
+        GOB_OP(CallNative):
+            GOB_CALL_HANDLER(pushToStack(callNative(_getBoundNative(ip->a), ip->b)));
+            GOB_NEXT_AFTER_CALL();
+        GOB_OP(Set):
+            GOB_CALL_HANDLER(_set());
+            GOB_COLLECT_GARBAGE();
+            GOB_NEXT();
+        GOB_OP(Get):
+            GOB_CALL_HANDLER(_get());
+            GOB_NEXT();
+        GOB_OP(GetLocal):
+            GOB_PUSH(m_variables[ip->a]);
+            GOB_NEXT();
+        GOB_OP(SetLocal):
+            setLocalVariableValue(ip->a, GOB_TOP);
+            GOB_POP();
+            GOB_COLLECT_GARBAGE();
+            GOB_NEXT();
+        GOB_OP(GetArray):
+        {
+            MemoryValue const &index = GOB_SECOND;
+            MemoryValue const &array = GOB_TOP;
+            if (index.getType() == Type::Int && array.getType() == Type::MemoryObj && array.getObject()->getKind() == MemoryKind::Array)
+            {
+                ip->op = Operation::GetArrayIndexInt;
+            }
+            GOB_CALL_HANDLER(_getArray());
+            GOB_NEXT();
+        }
+        GOB_OP(SetArray):
+            GOB_CALL_HANDLER(_setArray());
+            GOB_COLLECT_GARBAGE();
+            GOB_NEXT();
+        GOB_OP(PushConstInt):
+            GOB_PUSH(MemoryValue::makeInt(ip->value));
+            GOB_NEXT();
+        GOB_OP(PushConstChar):
+            GOB_PUSH(MemoryValue::makeChar((char)ip->value));
+            GOB_NEXT();
+        GOB_OP(PushConstString):
+            GOB_CALL_HANDLER(_pushConstString(ip->a));
+            GOB_NEXT();
+        GOB_OP(PushTrue):
+            GOB_PUSH(MemoryValue::makeBool(true));
+            GOB_NEXT();
+        GOB_OP(PushFalse):
+            GOB_PUSH(MemoryValue::makeBool(false));
+            GOB_NEXT();
+        GOB_OP(Equals):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            if (a.getType() != b.getType())
+            {
+                throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.getType()) + " and " + typeToString(b.getType()));
+            }
+            if (a.getType() == Type::Char)
+            {
+                ip->op = Operation::EqChar;
+            }
+            GOB_BINARY_RESULT(MemoryValue::makeBool(areEqual(a, b)));
+            GOB_NEXT();
+        }
+        GOB_OP(NotEq):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            if (a.getType() != b.getType())
+            {
+                throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.getType()) + " and " + typeToString(b.getType()));
+            }
+            GOB_BINARY_RESULT(MemoryValue::makeBool(!areEqual(a, b)));
+            GOB_NEXT();
+        }
+        GOB_OP(Less):
+        {
+            if (GOB_SECOND.getType() == Type::Int && GOB_TOP.getType() == Type::Int)
+            {
+                ip->op = Operation::LessIntInt;
+            }
+            MemoryValue res = GOB_SECOND;
+            GOB_NUMERIC_COMPARE(<, res, GOB_TOP);
+            GOB_BINARY_RESULT(res);
+            GOB_NEXT();
+        }
+        GOB_OP(More):
+        {
+            MemoryValue res = GOB_SECOND;
+            GOB_NUMERIC_COMPARE(>, res, GOB_TOP);
+            GOB_BINARY_RESULT(res);
+            GOB_NEXT();
+        }
+        GOB_OP(LessOrEq):
+        {
+            MemoryValue res = GOB_SECOND;
+            GOB_NUMERIC_COMPARE(<=, res, GOB_TOP);
+            GOB_BINARY_RESULT(res);
+            GOB_NEXT();
+        }
+        GOB_OP(MoreOrEq):
+        {
+            MemoryValue res = GOB_SECOND;
+            GOB_NUMERIC_COMPARE(>=, res, GOB_TOP);
+            GOB_BINARY_RESULT(res);
+            GOB_NEXT();
+        }
+        GOB_OP(And):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            if (a.getType() != Type::Bool || b.getType() != Type::Bool)
+            {
+                throw RuntimeException(std::string("Attempted to 'and' values of ") + typeToString(a.getType()) + " and " + typeToString(b.getType()));
+            }
+            GOB_BINARY_RESULT(MemoryValue::makeBool(a.getBool() && b.getBool()));
+            GOB_NEXT();
+        }
+        GOB_OP(Or):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            if (a.getType() != Type::Bool || b.getType() != Type::Bool)
+            {
+                throw RuntimeException(std::string("Attempted to 'or' values of ") + typeToString(a.getType()) + " and " + typeToString(b.getType()));
+            }
+            GOB_BINARY_RESULT(MemoryValue::makeBool(a.getBool() || b.getBool()));
+            GOB_NEXT();
+        }
+        GOB_OP(Not):
+        {
+            MemoryValue &val = GOB_TOP;
+            if (val.getType() != Type::Bool)
+            {
+                throw RuntimeException("Attempted to negate non boolean value");
+            }
+            val = MemoryValue::makeBool(!val.getBool());
+            GOB_NEXT();
+        }
+        GOB_OP(Negate):
+        {
+            MemoryValue &val = GOB_TOP;
+            switch (val.getType())
+            {
+            case Type::Int:
+                val = MemoryValue::makeInt(-val.getInt());
+                break;
+            case Type::Number:
+                val = MemoryValue::makeNumber(-val.getNumber());
+                break;
+            default:
+                throw RuntimeException("Attempted to apply negate operation on a non numeric value");
+            }
+            GOB_NEXT();
+        }
+        GOB_OP(Jump):
+#ifdef GOB_JIT_AVAILABLE
+            if constexpr (!SingleStep)
+            {
+                size_t jumpId = ip - instructions;
+                // only backward jumps close loops, so only they are counted
+                if (m_jitEnabled && ip->target <= jumpId && ++m_loopHits[jumpId] >= JIT_HOT_LOOP_THRESHOLD)
+                {
+                    ip = instructions + ip->target;
+                    GOB_SAFEPOINT(jumpId - (ip - instructions) + 1);
+                    size_t resumeAt;
+                    bool ran;
+                    GOB_CALL_HANDLER(ran = _runJitLoop(jumpId, budget, resumeAt));
+                    if (ran)
+                    {
+                        ip = instructions + resumeAt;
+                        if (budget <= 0)
+                        {
+                            status = RunStatus::BudgetExhausted;
+                            goto finish;
+                        }
+                    }
+                    GOB_DISPATCH();
+                }
+            }
+#endif
+            GOB_JUMP();
+        GOB_OP(JumpIfNot):
+        {
+            // condition is consumed by the jump, otherwise every loop iteration would leave a value on the stack
+            MemoryValue const &a = GOB_TOP;
+            if (a.getType() != Type::Bool)
+            {
+                throw RuntimeException(std::string("Invalid data type passed to condition check. Expected bool got: ") + typeToString(a.getType()));
+            }
+            bool condition = a.getBool();
+            GOB_POP();
+            if (!condition)
+            {
+                GOB_JUMP();
+            }
+            GOB_NEXT();
+        }
+        GOB_OP(ShrinkLocal):
+            shrinkLocalVariableStackBy((size_t)ip->a);
+            GOB_COLLECT_GARBAGE();
+            GOB_NEXT();
+        GOB_OP(IncLocalByConst):
+        {
+            MemoryValue &val = m_variables[ip->a];
+            GOB_CHECK_INTEGERS("add", val, (MemoryValue::makeInt(0)));
+            val = MemoryValue::makeInt(val.getInt() + ip->value);
+            GOB_NEXT();
+        }
+        GOB_OP(DecLocalByConst):
+        {
+            MemoryValue &val = m_variables[ip->a];
+            GOB_CHECK_INTEGERS("subtract", val, (MemoryValue::makeInt(0)));
+            val = MemoryValue::makeInt(val.getInt() - ip->value);
+            GOB_NEXT();
+        }
+        GOB_OP(JumpIfLocalNotLessLocal):
+        {
+            MemoryValue a = m_variables[ip->a];
+            MemoryValue const &b = m_variables[ip->b];
+            GOB_NUMERIC_COMPARE(<, a, b);
+            if (!a.getBool())
+            {
+                GOB_JUMP();
+            }
+            GOB_NEXT();
+        }
+        GOB_OP(JumpIfLocalNotLessConst):
+        {
+            MemoryValue const &a = m_variables[ip->a];
+            if (a.getType() != Type::Int)
+            {
+                throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.getType()) + " and " + typeToString(Type::Int));
+            }
+            if (!(a.getInt() < ip->value))
+            {
+                GOB_JUMP();
+            }
+            GOB_NEXT();
+        }
+        GOB_OP(GetLocalArrayItem):
+        {
+            MemoryValue item = getArrayItem(m_variables[ip->a], m_variables[ip->b]);
+            GOB_PUSH(item);
+            GOB_NEXT();
+        }
+        GOB_OP(GetGlobalConst):
+        {
+            GOB_PUSH(getGlobal(m_constStrings[(size_t)ip->a]));
+            GOB_NEXT();
+        }
+        GOB_OP(Pop):
+            GOB_POP();
+            GOB_NEXT();
+        GOB_OP(RegMove):
+        {
+            MemoryValue val = GOB_REGISTER(b);
+            GOB_SET_REGISTER(a, val);
+            if (ip->a < m_registerBase)
+            {
+                GOB_COLLECT_GARBAGE();
+            }
+            GOB_NEXT();
+        }
+        GOB_OP(RegLoadInt):
+            GOB_SET_REGISTER(a, (MemoryValue::makeInt(ip->value)));
+            GOB_NEXT();
+        GOB_OP(RegLoadChar):
+            GOB_SET_REGISTER(a, (MemoryValue::makeChar((char)ip->value)));
+            GOB_NEXT();
+        GOB_OP(RegLoadBool):
+            GOB_SET_REGISTER(a, (MemoryValue::makeBool(ip->value != 0)));
+            GOB_NEXT();
+        GOB_OP(RegLoadString):
+        {
+            StringNode *node = _createYoungString(m_constStrings[(size_t)ip->b]);
+            GOB_SET_REGISTER(a, (MemoryValue::makeObject(node)));
+            GOB_NEXT();
+        }
+        GOB_OP(RegGetGlobal):
+        {
+            MemoryValue val = getGlobal(m_constStrings[(size_t)ip->b]);
+            GOB_SET_REGISTER(a, val);
+            GOB_NEXT();
+        }
+        GOB_OP(RegSetGlobal):
+            setGlobal(m_constStrings[(size_t)ip->a], GOB_REGISTER(b));
+            GOB_COLLECT_GARBAGE();
+            GOB_NEXT();
+        GOB_OP(RegAdd):
+        {
+            GOB_CHECK_INTEGERS("add", GOB_REGISTER(b), GOB_REGISTER(c));
+            MemoryValue res = MemoryValue::makeInt(GOB_REGISTER(b).getInt() + GOB_REGISTER(c).getInt());
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT();
+        }
+        GOB_OP(RegSub):
+        {
+            GOB_CHECK_INTEGERS("subtract", GOB_REGISTER(b), GOB_REGISTER(c));
+            MemoryValue res = MemoryValue::makeInt(GOB_REGISTER(b).getInt() - GOB_REGISTER(c).getInt());
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT();
+        }
+        GOB_OP(RegEquals):
+        GOB_OP(RegNotEq):
+        {
+            MemoryValue const &a = GOB_REGISTER(b);
+            MemoryValue const &b = GOB_REGISTER(c);
+            if (a.getType() != b.getType())
+            {
+                throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.getType()) + " and " + typeToString(b.getType()));
+            }
+            bool equal = areEqual(a, b);
+            GOB_SET_REGISTER(a, (MemoryValue::makeBool(ip->op == Operation::RegEquals ? equal : !equal)));
+            GOB_NEXT();
+        }
+        GOB_OP(RegLess):
+        {
+            MemoryValue res = GOB_REGISTER(b);
+            GOB_NUMERIC_COMPARE(<, res, GOB_REGISTER(c));
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT();
+        }
+        GOB_OP(RegMore):
+        {
+            MemoryValue res = GOB_REGISTER(b);
+            GOB_NUMERIC_COMPARE(>, res, GOB_REGISTER(c));
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT();
+        }
+        GOB_OP(RegLessOrEq):
+        {
+            MemoryValue res = GOB_REGISTER(b);
+            GOB_NUMERIC_COMPARE(<=, res, GOB_REGISTER(c));
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT();
+        }
+        GOB_OP(RegMoreOrEq):
+        {
+            MemoryValue res = GOB_REGISTER(b);
+            GOB_NUMERIC_COMPARE(>=, res, GOB_REGISTER(c));
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT();
+        }
+        GOB_OP(RegAnd):
+        GOB_OP(RegOr):
+        {
+            MemoryValue const &a = GOB_REGISTER(b);
+            MemoryValue const &b = GOB_REGISTER(c);
+            if (a.getType() != Type::Bool || b.getType() != Type::Bool)
+            {
+                throw RuntimeException(std::string("Attempted to use logical operation on values of ") + typeToString(a.getType()) + " and " + typeToString(b.getType()));
+            }
+            bool res = ip->op == Operation::RegAnd ? (a.getBool() && b.getBool())
+                                                                 : (a.getBool() || b.getBool());
+            GOB_SET_REGISTER(a, (MemoryValue::makeBool(res)));
+            GOB_NEXT();
+        }
+        GOB_OP(RegNot):
+        {
+            MemoryValue const &val = GOB_REGISTER(b);
+            if (val.getType() != Type::Bool)
+            {
+                throw RuntimeException("Attempted to negate non boolean value");
+            }
+            GOB_SET_REGISTER(a, (MemoryValue::makeBool(!val.getBool())));
+            GOB_NEXT();
+        }
+        GOB_OP(RegNegate):
+        {
+            MemoryValue res = GOB_REGISTER(b);
+            switch (res.getType())
+            {
+            case Type::Int:
+                res = MemoryValue::makeInt(-res.getInt());
+                break;
+            case Type::Number:
+                res = MemoryValue::makeNumber(-res.getNumber());
+                break;
+            default:
+                throw RuntimeException("Attempted to apply negate operation on a non numeric value");
+            }
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT();
+        }
+        GOB_OP(RegGetArray):
+        {
+            MemoryValue item = getArrayItem(GOB_REGISTER(b), GOB_REGISTER(c));
+            GOB_SET_REGISTER(a, item);
+            GOB_NEXT();
+        }
+        GOB_OP(RegSetArray):
+            setArrayItem(GOB_REGISTER(a), GOB_REGISTER(b), GOB_REGISTER(c));
+            GOB_COLLECT_GARBAGE();
+            GOB_NEXT();
+        GOB_OP(RegCall):
+        {
+            size_t first = ip->c;
+            size_t argCount = ip->value;
+            for (size_t i = 0; i < argCount; i++)
+            {
+                GOB_PUSH(m_variables[first + i]);
+            }
+            MemoryValue func = GOB_REGISTER(b);
+            MemoryValue res;
+            GOB_CALL_HANDLER(res = callFunction(func, argCount));
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT_AFTER_CALL();
+        }
+        GOB_OP(RegCallNative):
+        {
+            size_t first = ip->c;
+            size_t argCount = ip->value;
+            for (size_t i = 0; i < argCount; i++)
+            {
+                GOB_PUSH(m_variables[first + i]);
+            }
+            MemoryValue res;
+            GOB_CALL_HANDLER(res = callNative(_getBoundNative(ip->b), argCount));
+            GOB_SET_REGISTER(a, res);
+            GOB_NEXT_AFTER_CALL();
+        }
+        GOB_OP(RegJumpIfNot):
+        {
+            MemoryValue const &a = GOB_REGISTER(a);
+            if (a.getType() != Type::Bool)
+            {
+                throw RuntimeException(std::string("Invalid data type passed to condition check. Expected bool got: ") + typeToString(a.getType()));
+            }
+            if (!a.getBool())
+            {
+                GOB_JUMP();
+            }
+            GOB_NEXT();
+        }
+        GOB_OP(AddIntInt):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            if (a.getType() != Type::Int || b.getType() != Type::Int)
+            {
+                GOB_DEOPTIMIZE(Add);
+            }
+            GOB_BINARY_RESULT(MemoryValue::makeInt(a.getInt() + b.getInt()));
+            GOB_NEXT();
+        }
+        GOB_OP(LessIntInt):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            if (a.getType() != Type::Int || b.getType() != Type::Int)
+            {
+                GOB_DEOPTIMIZE(Less);
+            }
+            GOB_BINARY_RESULT(MemoryValue::makeBool(a.getInt() < b.getInt()));
+            GOB_NEXT();
+        }
+        GOB_OP(EqChar):
+        {
+            MemoryValue const &a = GOB_SECOND;
+            MemoryValue const &b = GOB_TOP;
+            if (a.getType() != Type::Char || b.getType() != Type::Char)
+            {
+                GOB_DEOPTIMIZE(Equals);
+            }
+            GOB_BINARY_RESULT(MemoryValue::makeBool(a.getChar() == b.getChar()));
+            GOB_NEXT();
+        }
+        GOB_OP(GetArrayIndexInt):
+        {
+            MemoryValue const &index = GOB_SECOND;
+            MemoryValue const &array = GOB_TOP;
+            ArrayNode *arr = nullptr;
+            if (index.getType() != Type::Int || array.getType() != Type::MemoryObj ||
+                (arr = memoryCast<ArrayNode>(array.getObject())) == nullptr)
+            {
+                GOB_DEOPTIMIZE(GetArray);
+            }
+            GOB_BINARY_RESULT(*arr->getItem(index.getInt()));
+            GOB_NEXT();
+        }
+        GOB_OP(End):
+            m_forcedEnd = true;
+            ip++;
+            goto finish;
+#ifndef GOB_THREADED_DISPATCH
+        default:
+            std::cerr << "Invalid op code: " << (int32_t)ip->op << std::endl;
+            GOB_NEXT();
+#endif
+        }
+    }
+    catch (...)
+    {
+        GOB_SAVE_STATE();
+        throw;
+    }
+finish:
+    GOB_SAVE_STATE();
+    return status;
+}
+
+#undef GOB_SET_REGISTER
+#undef GOB_REGISTER
+#undef GOB_CHECK_INTEGERS
+#undef GOB_NUMERIC_COMPARE
+#undef GOB_CALL_HANDLER
+#undef GOB_COLLECT_GARBAGE
+#undef GOB_BINARY_RESULT
+#undef GOB_POP
+#undef GOB_PUSH
+#undef GOB_SECOND
+#undef GOB_TOP
+#undef GOB_LOAD_STATE
+#undef GOB_SAVE_STATE
+#undef GOB_DEOPTIMIZE
+#undef GOB_SAFEPOINT
+#undef GOB_NEXT_AFTER_CALL
+#undef GOB_JUMP
+#undef GOB_NEXT
+#undef GOB_DISPATCH
+#undef GOB_OP
+
+void GobLang::Machine::_prepareOperations()
+{
+    if (m_operationsPrepared)
+    {
+        return;
+    }
+    m_instructions.clear();
+    // maps byte offset of every operation to its instruction index, which is needed to convert jump addresses
+    std::map<size_t, uint32_t> instructionStarts;
+    std::vector<size_t> jumpAddressOffsets;
+    size_t pc = 0;
+    while (pc < m_operations.size())
+    {
+        Operation op = (Operation)m_operations[pc];
+        OperationData const *opData = getOperationData(op);
+        if (opData == nullptr)
+        {
+            throw RuntimeException(std::string("Invalid op code: ") + std::to_string((int32_t)op) + " at " + std::to_string(pc));
+        }
+        if (pc + 1 + opData->argCount > m_operations.size())
+        {
+            throw RuntimeException("Last operation is missing its arguments");
+        }
+        Instruction instr = {.op = op};
+        uint8_t *args[] = {&instr.a, &instr.b, &instr.c};
+        for (int32_t i = 0; i < opData->argCount && i < 3; i++)
+        {
+            *args[i] = m_operations[pc + 1 + i];
+        }
+        switch (op)
+        {
+        case Operation::PushConstInt:
+            instr.value = m_constInts.at(instr.a);
+            break;
+        case Operation::PushConstChar:
+            instr.value = (char)instr.a;
+            break;
+        case Operation::IncLocalByConst:
+        case Operation::DecLocalByConst:
+        case Operation::JumpIfLocalNotLessConst:
+        case Operation::RegLoadInt:
+            instr.value = m_constInts.at(instr.b);
+            break;
+        case Operation::RegLoadChar:
+            instr.value = (char)instr.b;
+            break;
+        case Operation::RegLoadBool:
+            instr.value = instr.b != 0;
+            break;
+        case Operation::RegCall:
+        case Operation::RegCallNative:
+            instr.value = m_operations[pc + 4];
+            break;
+        default:
+            break;
+        }
+        if (opData->isJump)
+        {
+            jumpAddressOffsets.push_back(pc + 1 + opData->argCount - sizeof(ProgramAddressType));
+        }
+        instructionStarts[pc] = (uint32_t)m_instructions.size();
+        m_instructions.push_back(instr);
+        pc += 1 + opData->argCount;
+    }
+    if (m_instructions.empty() || m_instructions.back().op != Operation::End)
+    {
+        // guarantees that execution never runs past the instructions without checking the counter on every operation
+        instructionStarts[pc] = (uint32_t)m_instructions.size();
+        m_instructions.push_back(Instruction{.op = Operation::End});
+    }
+    else
+    {
+        // jumping right past the last operation ends the program
+        instructionStarts[pc] = (uint32_t)m_instructions.size() - 1;
+    }
+    // jumps are decoded in the same order as the instructions that own them
+    size_t jumpId = 0;
+    for (Instruction &instr : m_instructions)
+    {
+        OperationData const *opData = getOperationData(instr.op);
+        if (!opData->isJump)
+        {
+            continue;
+        }
+        ProgramAddressType address = _getAddressFromByteCode(jumpAddressOffsets[jumpId++]);
+        std::map<size_t, uint32_t>::const_iterator it = instructionStarts.find(address);
+        if (it == instructionStarts.end())
+        {
+            throw RuntimeException(std::string("Jump to address ") + std::to_string(address) + " that is not a start of an operation");
+        }
+        instr.target = it->second;
+    }
+    Verifier verifier(m_instructions, m_constStrings.size(), m_constNatives.size());
+    verifier.verify();
+    m_maxStackDepth = verifier.getMaxStackDepth();
+    // every local variable the code can address exists, so handlers don't need to check ids
+    reserveLocalVariables(verifier.getLocalCount());
+    m_loopHits.assign(m_instructions.size(), 0);
+    for (std::pair<const size_t, JitLoop *> &loop : m_jitLoops)
+    {
+        delete loop.second;
+    }
+    m_jitLoops.clear();
+    m_operationsPrepared = true;
+}
+
+bool GobLang::Machine::_runJitLoop(size_t jumpId, int64_t &budget, size_t &resumeAt)
+{
+    std::map<size_t, JitLoop *>::iterator it = m_jitLoops.find(jumpId);
+    if (it == m_jitLoops.end())
+    {
+        it = m_jitLoops.insert({jumpId, new JitLoop(m_instructions, m_instructions[jumpId].target, jumpId, m_variables, m_localVariableCount)}).first;
+    }
+    if (!it->second->run(m_variables, m_localVariableCount, budget, resumeAt))
+    {
+        // loop is either not compiled or state doesn't match, wait for another full threshold before trying again
+        m_loopHits[jumpId] = 0;
+        return false;
+    }
+    if (resumeAt >= m_instructions[jumpId].target && resumeAt <= jumpId)
+    {
+        // native code gave up inside of the loop body, entering it again on the next iteration would only pay for the transition
+        m_loopHits[jumpId] = 0;
+    }
+    return true;
+}
+
+size_t GobLang::Machine::getCompiledLoopCount() const
+{
+    size_t count = 0;
+    for (std::pair<const size_t, JitLoop *> const &loop : m_jitLoops)
+    {
+        if (loop.second->isCompiled())
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+void GobLang::Machine::_growOperationStack()
+{
+    m_operationStack.resize(m_operationStack.size() * 2);
+}
+
+void GobLang::Machine::_reserveOperationStack()
+{
+    if (m_operationStack.size() < m_operationStackSize + m_maxStackDepth + 1)
+    {
+        m_operationStack.resize(m_operationStackSize + m_maxStackDepth + 1);
+    }
 }
 
 void GobLang::Machine::printGlobalsInfo()
 {
     for (std::map<std::string, MemoryValue>::iterator it = m_globals.begin(); it != m_globals.end(); it++)
     {
-        std::cout << it->first << "(" << typeToString(it->second.type) << ")" << " = " << valueToString(it->second) << std::endl;
+        std::cout << it->first << "(" << typeToString(it->second.getType()) << ")" << " = " << valueToString(it->second) << std::endl;
+    }
+}
+
+void GobLang::Machine::printVariablesInfo()
+{
+    std::cout << "Local(" << m_variables.size() << "):" << std::endl;
+    for (std::vector<MemoryValue>::iterator it = m_variables.begin(); it != m_variables.end(); it++)
+    {
+        std::cout << it - m_variables.begin() << ": " << typeToString(it->getType()) << " = " << valueToString(*it) << std::endl;
+    }
+}
+
+void GobLang::Machine::printStack()
+{
+    std::cout << "Stack(" << m_operationStackSize << "):" << std::endl;
+    for (size_t i = 0; i < m_operationStackSize; i++)
+    {
+        MemoryValue const &val = _stackBase()[m_operationStackSize - i - 1];
+        std::cout << i << ": " << typeToString(val.getType()) << " = " << valueToString(val) << std::endl;
+    }
+}
+
+GobLang::MemoryValue *GobLang::Machine::getStackTop()
+
+{
+    if (m_operationStackSize == 0)
+    {
+        return nullptr;
+    }
+    else
+    {
+        return &_stackBase()[m_operationStackSize - 1];
+    }
+}
+
+GobLang::ArrayNode *GobLang::Machine::createArrayOfSize(int32_t size)
+{
+    if (size < 0)
+    {
+        throw RuntimeException(std::string("Attempted to create array of negative size: ") + std::to_string(size));
+    }
+    ArrayNode *node = ArrayNode::create(m_pool.allocate(ArrayNode::getAllocationSize(size)), size);
+    _registerObject(node);
+    return node;
+}
+
+GobLang::StringNode *GobLang::Machine::createString(std::string const &str, bool alwaysNew)
+{
+    if (alwaysNew)
+    {
+        StringNode *node = new (m_pool.allocate(sizeof(StringNode))) StringNode(str);
+        _registerObject(node);
+        return node;
+    }
+    // avoid making instance for each call, check if there is anything that uses this already
+    if (std::unordered_map<std::string_view, StringNode *>::iterator it = m_stringIndex.find(str); it != m_stringIndex.end())
+    {
+        StringNode *found = it->second;
+        // unmarked objects that are not swept yet might be garbage, reusing them would bring them back after they are deleted
+        bool maybeGarbage = m_gcMode == GarbageCollectorMode::Tracing && m_gcInProgress && !found->isMarked();
+        if (!maybeGarbage)
+        {
+            return found;
+        }
+        found->setInterned(false);
+        m_stringIndex.erase(it);
+    }
+    StringNode *node = new (m_pool.allocate(sizeof(StringNode))) StringNode(str);
+    _registerObject(node);
+    m_stringIndex.emplace(node->getString(), node);
+    node->setInterned(true);
+    return node;
+}
+
+void GobLang::Machine::popStack()
+{
+    m_operationStackSize--;
+}
+
+void GobLang::Machine::pushToStack(MemoryValue const &val)
+{
+    if (m_operationStackSize + 1 == m_operationStack.size())
+    {
+        _growOperationStack();
+    }
+    _stackBase()[m_operationStackSize++] = val;
+}
+
+void GobLang::Machine::setLocalVariableValue(size_t id, MemoryValue const &val)
+{
+    MemoryValue stored = _promote(val);
+    if (id >= m_variables.size())
+    {
+        m_variables.resize(id + 1);
+    }
+    if (id >= m_localVariableCount)
+    {
+        m_localVariableCount = id + 1;
+    }
+    if (m_gcMode != GarbageCollectorMode::ReferenceCounting)
+    {
+        m_variables[id] = stored;
+        return;
+    }
+    if (stored.getType() == Type::MemoryObj)
+    {
+        stored.getObject()->increaseRefCount();
+    }
+    if (m_variables[id].getType() == Type::MemoryObj)
+    {
+        m_variables[id].getObject()->decreaseRefCount();
+        _releaseObject(m_variables[id].getObject());
+    }
+    m_variables[id] = stored;
+}
+
+void GobLang::Machine::reserveLocalVariables(size_t count)
+{
+    if (m_variables.size() < count)
+    {
+        m_variables.resize(count);
+    }
+}
+
+GobLang::MemoryValue *GobLang::Machine::getLocalVariableValue(size_t id)
+{
+    if (m_variables.size() < id)
+    {
+        return nullptr;
+    }
+    return &m_variables[id];
+}
+
+void GobLang::Machine::shrinkLocalVariableStackBy(size_t size)
+{
+    for (size_t i = 0; i < size && i < m_localVariableCount; i++)
+    {
+        size_t ind = m_localVariableCount - i - 1;
+        if (m_gcMode == GarbageCollectorMode::ReferenceCounting && m_variables[ind].getType() == Type::MemoryObj)
+        {
+            m_variables[ind].getObject()->decreaseRefCount();
+            _releaseObject(m_variables[ind].getObject());
+        }
+        // value is no longer owned by anything so it should not be released again by the next block that uses this id
+        m_variables[ind] = MemoryValue::makeNull();
+    }
+    m_localVariableCount = size > m_localVariableCount ? 0 : m_localVariableCount - size;
+}
+
+void GobLang::Machine::createVariable(std::string const &name, MemoryValue const &value)
+{
+    setGlobal(name, value);
+}
+
+namespace
+{
+    /**
+     * @brief Call the function for every object referenced by the node. Only arrays reference other objects and references to itself are not counted
+     *
+     */
+    template <class Func>
+    void forEachReference(GobLang::MemoryNode *node, Func const &func)
+    {
+        if (GobLang::ArrayNode *arr = GobLang::memoryCast<GobLang::ArrayNode>(node); arr != nullptr)
+        {
+            for (size_t i = 0; i < arr->getSize(); i++)
+            {
+                GobLang::MemoryValue const *item = arr->getItem(i);
+                if (item->getType() == GobLang::Type::MemoryObj && item->getObject() != arr)
+                {
+                    func(item->getObject());
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Get size of the block that was allocated for the object in the memory pool
+     *
+     */
+    size_t getAllocationSize(GobLang::MemoryNode *node)
+    {
+        switch (node->getKind())
+        {
+        case GobLang::MemoryKind::Array:
+            return GobLang::ArrayNode::getAllocationSize(static_cast<GobLang::ArrayNode *>(node)->getSize());
+        case GobLang::MemoryKind::String:
+            return sizeof(GobLang::StringNode);
+        default:
+            throw GobLang::RuntimeException("Machine doesn't allocate objects of this kind");
+        }
+    }
+
+    /**
+     * @brief Check if the object owns memory that doesn't come from pool chunks, so it can't be freed by rewinding the pool
+     *
+     */
+    bool ownsExternalMemory(GobLang::MemoryNode *node)
+    {
+        // strings short enough for the small string buffer keep their characters inside the node
+        static size_t const smallStringCapacity = std::string().capacity();
+        switch (node->getKind())
+        {
+        case GobLang::MemoryKind::Array:
+            return getAllocationSize(node) > GobLang::MemoryPool::MaxBlockSize;
+        case GobLang::MemoryKind::String:
+        {
+            GobLang::StringNode *str = static_cast<GobLang::StringNode *>(node);
+            return !str->isShared() && str->getString().capacity() > smallStringCapacity;
+        }
+        default:
+            throw GobLang::RuntimeException("Machine doesn't allocate objects of this kind");
+        }
     }
-}
 
-void GobLang::Machine::printVariablesInfo()
-{
-    std::cout << "Local(" << m_variables.size() << "):" << std::endl;
-    for (std::vector<MemoryValue>::iterator it = m_variables.begin(); it != m_variables.end(); it++)
+    /**
+     * @brief Get approximate amount of memory used by the object, including storage owned by it
+     *
+     */
+    size_t getObjectSize(GobLang::MemoryNode *node)
     {
-        std::cout << it - m_variables.begin() << ": " << typeToString(it->type) << " = " << valueToString(*it) << std::endl;
+        if (GobLang::StringNode *str = GobLang::memoryCast<GobLang::StringNode>(node); str != nullptr && !str->isShared())
+        {
+            return getAllocationSize(node) + str->getSize();
+        }
+        return getAllocationSize(node);
     }
 }
 
-void GobLang::Machine::printStack()
+void GobLang::Machine::collectGarbage()
 {
-    std::cout << "Stack(" << m_operationStack.size() << "):" << std::endl;
-    for (std::vector<MemoryValue>::reverse_iterator it = m_operationStack.rbegin(); it != m_operationStack.rend(); it++)
+    if (m_gcMode == GarbageCollectorMode::Region)
     {
-        std::cout << it - m_operationStack.rbegin() << ": " << typeToString(it->type) << " = " << valueToString(*it) << std::endl;
+        return;
     }
-}
-
-GobLang::MemoryValue *GobLang::Machine::getStackTop()
-
-{
-    if (m_operationStack.empty())
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (m_gcMode == GarbageCollectorMode::Tracing)
     {
-        return nullptr;
+        if (!m_gcInProgress)
+        {
+            _markReachable();
+        }
+        _sweep();
     }
     else
     {
-        return &m_operationStack[m_operationStack.size() - 1];
+        _collectZeroCountTable();
+        if (m_memory.getSize() >= m_cycleLimit)
+        {
+            collectCycles();
+        }
     }
+    std::chrono::nanoseconds pause = std::chrono::steady_clock::now() - start;
+    m_gcStats.collections++;
+    m_gcStats.totalPause += pause;
+    m_gcStats.longestPause = std::max(m_gcStats.longestPause, pause);
 }
 
-GobLang::MemoryValue *GobLang::Machine::getStackTopAndPop()
+void GobLang::Machine::_collectZeroCountTable()
 {
-    if (m_operationStack.empty())
+    _markRoots(true);
+    std::vector<MemoryNode *> kept;
+    size_t freed = 0;
+    // deleting arrays can put their items into the table, so keep going until it is empty or the budget runs out
+    while (!m_zeroCountTable.empty() && (m_gcBudget == 0 || freed < m_gcBudget))
     {
-        return nullptr;
+        MemoryNode *node = m_zeroCountTable.back();
+        m_zeroCountTable.pop_back();
+        node->setInZeroCountTable(false);
+        if (node->getRefCount() > 0)
+        {
+            continue;
+        }
+        if (node->isMarked())
+        {
+            kept.push_back(node);
+            continue;
+        }
+        _freeObject(node);
+        freed++;
     }
-    else
+    _markRoots(false);
+    m_gcInProgress = !m_zeroCountTable.empty();
+    for (MemoryNode *node : kept)
     {
-        MemoryValue *m = new MemoryValue(m_operationStack[m_operationStack.size() - 1]);
-        m_operationStack.pop_back();
-        return m;
+        node->setInZeroCountTable(true);
+        m_zeroCountTable.push_back(node);
     }
+    // unfinished collection continues at the next safepoint
+    m_zeroCountLimit = m_gcInProgress ? 0 : std::max<size_t>(GC_ZERO_COUNT_THRESHOLD, kept.size() * 2);
 }
 
-GobLang::ArrayNode *GobLang::Machine::createArrayOfSize(int32_t size)
-{
-    ArrayNode *node = new ArrayNode(size);
-    m_memoryRoot->pushBack(node);
-    return node;
-}
-
-GobLang::StringNode *GobLang::Machine::createString(std::string const &str, bool alwaysNew)
+void GobLang::Machine::_markReachable()
 {
-    MemoryNode *root = m_memoryRoot;
-    StringNode *node = nullptr;
-    // avoid making instance for each call, check if there is anything that uses this already
-    while (root != nullptr && !alwaysNew)
+    auto markValue = [this](MemoryValue const &val)
     {
-        if (StringNode *strNode = dynamic_cast<StringNode *>(root); strNode != nullptr && strNode->getString() == str)
+        if (val.getType() == Type::MemoryObj && !val.getObject()->isMarked() && !m_nursery.contains(val.getObject()))
         {
-            node = strNode;
-            break;
+            val.getObject()->setMarked(true);
+            m_cycleWork.push_back(val.getObject());
         }
-        root = root->getNext();
+    };
+    for (size_t i = 0; i < m_operationStackSize; i++)
+    {
+        markValue(_stackBase()[i]);
     }
-    if (node == nullptr)
+    for (MemoryValue const &val : m_variables)
     {
-        node = new StringNode(str);
-        m_memoryRoot->pushBack(node);
+        markValue(val);
     }
-    return node;
+    for (std::pair<const std::string, MemoryValue> const &global : m_globals)
+    {
+        markValue(global.second);
+    }
+    while (!m_cycleWork.empty())
+    {
+        MemoryNode *node = m_cycleWork.back();
+        m_cycleWork.pop_back();
+        forEachReference(
+            node,
+            [this](MemoryNode *ref)
+            {
+                if (!ref->isMarked())
+                {
+                    ref->setMarked(true);
+                    m_cycleWork.push_back(ref);
+                }
+            });
+    }
+    // objects created after this point are not swept until the next collection, so they don't need to be marked
+    m_sweepCursor = m_memory.getFirst();
+    m_sweepEnd = m_memory.getLast();
+    m_sweepLiveBytes = 0;
+    m_allocatedBytes = 0;
+    m_gcInProgress = true;
 }
 
-void GobLang::Machine::popStack()
+void GobLang::Machine::_sweep()
 {
-    m_operationStack.pop_back();
+    size_t freed = 0;
+    while (m_sweepCursor != nullptr && (m_gcBudget == 0 || freed < m_gcBudget))
+    {
+        MemoryNode *node = m_sweepCursor;
+        m_sweepCursor = node == m_sweepEnd ? nullptr : node->getNext();
+        if (node->isMarked())
+        {
+            node->setMarked(false);
+            m_sweepLiveBytes += getObjectSize(node);
+        }
+        else
+        {
+            _deleteObject(node);
+            m_gcStats.freedObjects++;
+            freed++;
+        }
+    }
+    m_gcInProgress = m_sweepCursor != nullptr;
+    // unfinished collection continues at the next safepoint
+    m_allocationLimit = m_gcInProgress ? 0 : std::max<size_t>(GC_ALLOCATION_THRESHOLD, m_sweepLiveBytes);
 }
 
-void GobLang::Machine::pushToStack(MemoryValue const &val)
+void GobLang::Machine::collectCycles()
 {
-    m_operationStack.push_back(val);
-}
+    if (m_gcMode != GarbageCollectorMode::ReferenceCounting)
+    {
+        return;
+    }
+    _markRoots(true);
+    size_t candidates = 0;
+    for (MemoryNode *node : m_cycleRoots)
+    {
+        if (node->getColor() == CycleColor::Purple && node->getRefCount() > 0)
+        {
+            m_cycleRoots[candidates++] = node;
+            continue;
+        }
+        node->setBuffered(false);
+        if (node->isDead())
+        {
+            _deleteObject(node);
+        }
+        else
+        {
+            node->setColor(CycleColor::Black);
+        }
+    }
+    m_cycleRoots.resize(candidates);
+    for (MemoryNode *node : m_cycleRoots)
+    {
+        _markGray(node);
+    }
+    for (MemoryNode *node : m_cycleRoots)
+    {
+        _scan(node);
+    }
+    std::vector<MemoryNode *> garbage;
+    for (MemoryNode *node : m_cycleRoots)
+    {
+        node->setBuffered(false);
+        _collectWhite(node, garbage);
+    }
+    m_cycleRoots.clear();
+    _markRoots(false);
 
-void GobLang::Machine::setLocalVariableValue(size_t id, MemoryValue const &val)
-{
-    if (id >= m_variables.size())
+    for (MemoryNode *node : garbage)
     {
-        m_variables.resize(id + 1);
+        node->setDead(true);
     }
-    if (val.type == Type::MemoryObj)
+    // garbage that is also waiting in the zero count table must not be visited after it is deleted
+    m_zeroCountTable.erase(std::remove_if(m_zeroCountTable.begin(), m_zeroCountTable.end(), [](MemoryNode *node)
+                                          { return node->isDead(); }),
+                           m_zeroCountTable.end());
+    for (MemoryNode *node : garbage)
     {
-        std::get<MemoryNode *>(val.value)->increaseRefCount();
+        // references to objects outside of the cycle were already subtracted by the trial deletion
+        forEachReference(
+            node,
+            [this](MemoryNode *ref)
+            {
+                if (!ref->isDead())
+                {
+                    _releaseObject(ref);
+                }
+            });
     }
-    if (m_variables[id].type == Type::MemoryObj)
+    for (MemoryNode *node : garbage)
     {
-        std::get<MemoryNode *>(m_variables[id].value)->decreaseRefCount();
+        _deleteObject(node);
     }
-    m_variables[id] = val;
+    m_gcStats.cycleCollections++;
+    m_gcStats.freedCycleObjects += garbage.size();
+    m_cycleLimit = std::max<size_t>(GC_CYCLE_THRESHOLD, m_memory.getSize() * 2);
 }
 
-GobLang::MemoryValue *GobLang::Machine::getLocalVariableValue(size_t id)
+void GobLang::Machine::_markGray(MemoryNode *node)
 {
-    if (m_variables.size() < id)
+    if (node->getColor() == CycleColor::Gray)
     {
-        return nullptr;
+        return;
+    }
+    node->setColor(CycleColor::Gray);
+    size_t base = m_cycleWork.size();
+    m_cycleWork.push_back(node);
+    while (m_cycleWork.size() > base)
+    {
+        MemoryNode *curr = m_cycleWork.back();
+        m_cycleWork.pop_back();
+        forEachReference(
+            curr,
+            [this](MemoryNode *ref)
+            {
+                ref->decreaseRefCount();
+                if (ref->getColor() != CycleColor::Gray)
+                {
+                    ref->setColor(CycleColor::Gray);
+                    m_cycleWork.push_back(ref);
+                }
+            });
     }
-    return &m_variables[id];
 }
 
-void GobLang::Machine::shrinkLocalVariableStackBy(size_t size)
+void GobLang::Machine::_scan(MemoryNode *node)
 {
-    for (size_t i = 0; i < size; i++)
+    size_t base = m_cycleWork.size();
+    m_cycleWork.push_back(node);
+    while (m_cycleWork.size() > base)
     {
-        size_t ind = m_variables.size() - i - 1;
-        if (m_variables[ind].type == Type::MemoryObj)
+        MemoryNode *curr = m_cycleWork.back();
+        m_cycleWork.pop_back();
+        if (curr->getColor() != CycleColor::Gray)
+        {
+            continue;
+        }
+        // values on the operation stack and in registers are references from outside of the graph that are not counted
+        if (curr->getRefCount() > 0 || curr->isMarked())
         {
-            std::get<MemoryNode *>(m_variables[ind].value)->decreaseRefCount();
+            _scanBlack(curr);
+            continue;
         }
+        curr->setColor(CycleColor::White);
+        forEachReference(curr, [this](MemoryNode *ref)
+                         { m_cycleWork.push_back(ref); });
     }
-    // possibly add m_variables.resize(m_variables.size() - size)
 }
 
-void GobLang::Machine::createVariable(std::string const &name, MemoryValue const &value)
+void GobLang::Machine::_scanBlack(MemoryNode *node)
 {
-    m_globals[name] = value;
+    node->setColor(CycleColor::Black);
+    size_t base = m_cycleWork.size();
+    m_cycleWork.push_back(node);
+    while (m_cycleWork.size() > base)
+    {
+        MemoryNode *curr = m_cycleWork.back();
+        m_cycleWork.pop_back();
+        forEachReference(
+            curr,
+            [this](MemoryNode *ref)
+            {
+                ref->increaseRefCount();
+                if (ref->getColor() != CycleColor::Black)
+                {
+                    ref->setColor(CycleColor::Black);
+                    m_cycleWork.push_back(ref);
+                }
+            });
+    }
 }
 
-void GobLang::Machine::collectGarbage()
+void GobLang::Machine::_collectWhite(MemoryNode *node, std::vector<MemoryNode *> &garbage)
 {
-    MemoryNode *prev = m_memoryRoot;
-    MemoryNode *curr = m_memoryRoot->getNext();
-    while (curr != nullptr)
+    size_t base = m_cycleWork.size();
+    m_cycleWork.push_back(node);
+    while (m_cycleWork.size() > base)
     {
-        if (!curr->isDead())
+        MemoryNode *curr = m_cycleWork.back();
+        m_cycleWork.pop_back();
+        if (curr->getColor() != CycleColor::White || curr->isBuffered())
         {
-            prev = curr;
-            curr = curr->getNext();
             continue;
         }
-        // if we are deleting then prev should stay the same while
-        // curr gets deleted
-        MemoryNode *del = curr;
-        prev->eraseNext();
-        curr = prev->getNext();
-
-        delete del;
+        curr->setColor(CycleColor::Black);
+        garbage.push_back(curr);
+        forEachReference(curr, [this](MemoryNode *ref)
+                         { m_cycleWork.push_back(ref); });
     }
 }
 
-GobLang::Machine::~Machine()
+void GobLang::Machine::_registerObject(MemoryNode *node)
 {
-    MemoryNode *root = m_memoryRoot->getNext();
-    while (root != nullptr)
+    m_memory.pushBack(node);
+    if (m_gcMode == GarbageCollectorMode::Tracing)
+    {
+        m_allocatedBytes += getObjectSize(node);
+        return;
+    }
+    if (m_gcMode == GarbageCollectorMode::Region)
     {
-        MemoryNode *del = root;
-        root = root->getNext();
-        delete del;
+        if (ownsExternalMemory(node))
+        {
+            m_regionOwners.push_back(node);
+        }
+        return;
     }
-    delete m_memoryRoot;
+    node->setInZeroCountTable(true);
+    m_zeroCountTable.push_back(node);
 }
 
-GobLang::ProgramAddressType GobLang::Machine::_getAddressFromByteCode(size_t start)
+void GobLang::Machine::_collectGarbageAtSafepoint()
 {
-    ProgramAddressType reconAddr = 0x0;
-    for (int32_t i = 0; i < sizeof(ProgramAddressType); i++)
+    if (m_nursery.isFull())
     {
-        ProgramAddressType offset = (sizeof(ProgramAddressType) - i - 1) * 8;
-        reconAddr |= (ProgramAddressType)(m_operations[start + i]) << offset;
+        _evacuateNursery();
+    }
+    if (_isHeapCollectionNeeded())
+    {
+        collectGarbage();
     }
-    return reconAddr;
-}
-
-void GobLang::Machine::_jump()
-{
-    ProgramAddressType dest = _getAddressFromByteCode(m_programCounter + 1);
-    m_programCounter = dest;
 }
 
-void GobLang::Machine::_jumpIf()
+GobLang::StringNode *GobLang::Machine::_createYoungString(std::string const &constant)
 {
-    ProgramAddressType dest = _getAddressFromByteCode(m_programCounter + 1);
-    m_programCounter += sizeof(ProgramAddressType);
-    MemoryValue a = *m_operationStack.rbegin();
-    if (a.type == Type::Bool)
-    {
-        if (!std::get<bool>(a.value))
-        {
-            m_programCounter = dest;
-        }
-        else
-        {
-            m_programCounter++;
-        }
-    }
-    else
+    if (StringNode *node = m_nursery.createString(&constant); node != nullptr)
     {
-        throw RuntimeException(std::string("Invalid data type passed to condition check. Expected bool got: ") + typeToString(a.type));
+        return node;
     }
+    // nursery is cleared at the next safepoint, until then strings go to the heap
+    return _createSharedString(&constant);
 }
 
-void GobLang::Machine::_addInt()
+GobLang::StringNode *GobLang::Machine::_createSharedString(std::string const *constant)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 1];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 2];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    Value c = std::get<int32_t>(a.value) + std::get<int32_t>(b.value);
-    m_operationStack.push_back(MemoryValue{.type = Type::Int, .value = c});
+    StringNode *node = new (m_pool.allocate(sizeof(StringNode))) StringNode(constant);
+    _registerObject(node);
+    return node;
 }
 
-void GobLang::Machine::_subInt()
+GobLang::MemoryValue GobLang::Machine::_promote(MemoryValue const &val)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 1];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 2];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    Value c = std::get<int32_t>(b.value) - std::get<int32_t>(a.value);
-    m_operationStack.push_back(MemoryValue{.type = Type::Int, .value = c});
+    if (val.getType() != Type::MemoryObj || !m_nursery.contains(val.getObject()))
+    {
+        return val;
+    }
+    StringNode *str = static_cast<StringNode *>(val.getObject());
+    StringNode *node = str->isShared() ? _createSharedString(&str->getString()) : createString(str->getString(), true);
+    m_gcStats.promotedObjects++;
+    return MemoryValue::makeObject(node);
 }
 
-void GobLang::Machine::_set()
+void GobLang::Machine::_evacuateNursery()
 {
-    // (name val =)
-    MemoryValue val = m_operationStack[m_operationStack.size() - 1];
-    MemoryValue name = m_operationStack[m_operationStack.size() - 2];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    StringNode *memStr = dynamic_cast<StringNode *>(std::get<MemoryNode *>(name.value));
-    if (memStr != nullptr)
+    // same string can be in several places, all of them have to point to the same copy
+    std::vector<MemoryNode *> promoted(m_nursery.getSize(), nullptr);
+    auto evacuate = [this, &promoted](MemoryValue &val)
     {
-        if (val.type == Type::MemoryObj)
+        if (val.getType() != Type::MemoryObj || !m_nursery.contains(val.getObject()))
         {
-            std::get<MemoryNode *>(val.value)->increaseRefCount();
+            return;
         }
-        if (m_globals.count(memStr->getString()) > 0 && m_globals[memStr->getString()].type == Type::MemoryObj)
+        MemoryNode *&copy = promoted[m_nursery.getIndex(val.getObject())];
+        if (copy == nullptr)
         {
-            std::get<MemoryNode *>(m_globals[memStr->getString()].value)->decreaseRefCount();
+            copy = _promote(val).getObject();
         }
-        m_globals[memStr->getString()] = val;
+        val = MemoryValue::makeObject(copy);
+    };
+    for (size_t i = 0; i < m_operationStackSize; i++)
+    {
+        evacuate(_stackBase()[i]);
     }
+    for (MemoryValue &val : m_variables)
+    {
+        evacuate(val);
+    }
+    m_nursery.clear();
+    m_gcStats.nurseryCollections++;
 }
 
-void GobLang::Machine::_get()
+void GobLang::Machine::_releaseObject(MemoryNode *node)
 {
-    MemoryValue name = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    assert(std::holds_alternative<MemoryNode *>(name.value));
-    StringNode *memStr = dynamic_cast<StringNode *>(std::get<MemoryNode *>(name.value));
-    if (memStr != nullptr)
+    if (node->getRefCount() <= 0)
     {
-        if (m_globals.count(memStr->getString()) < 1)
+        if (!node->isInZeroCountTable())
         {
-            throw RuntimeException(std::string("Attempted to get variable '" + memStr->getString() + "', which doesn't exist"));
+            node->setInZeroCountTable(true);
+            m_zeroCountTable.push_back(node);
         }
-        m_operationStack.push_back(m_globals[memStr->getString()]);
+    }
+    else if (node->getKind() == MemoryKind::Array && !node->isBuffered())
+    {
+        // array is still in use, but the reference it lost might have been the last one from outside of a cycle
+        node->setColor(CycleColor::Purple);
+        node->setBuffered(true);
+        m_cycleRoots.push_back(node);
     }
 }
 
-void GobLang::Machine::_setLocal()
-{
-    MemoryValue val = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_programCounter++;
-    uint8_t id = m_operations[m_programCounter];
-    setLocalVariableValue(id, val);
-}
-
-void GobLang::Machine::_getLocal()
+void GobLang::Machine::_markRoots(bool marked)
 {
-    m_programCounter++;
-    uint8_t id = m_operations[m_programCounter];
-    if (MemoryValue *val = getLocalVariableValue(id); val != nullptr)
+    for (size_t i = 0; i < m_operationStackSize; i++)
     {
-        m_operationStack.push_back(*val);
+        if (_stackBase()[i].getType() == Type::MemoryObj)
+        {
+            _stackBase()[i].getObject()->setMarked(marked);
+        }
     }
-    else
+    for (MemoryValue const &val : m_variables)
     {
-        throw RuntimeException(std::string("Attempted to retrieve value of variable ") + std::to_string(id) + ", but no variable uses this id");
+        if (val.getType() == Type::MemoryObj)
+        {
+            val.getObject()->setMarked(marked);
+        }
     }
 }
 
-void GobLang::Machine::_call()
+void GobLang::Machine::_freeObject(MemoryNode *node)
 {
-    MemoryValue func = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    if (std::holds_alternative<FunctionValue>(func.value))
+    forEachReference(
+        node,
+        [this](MemoryNode *ref)
+        {
+            ref->decreaseRefCount();
+            _releaseObject(ref);
+        });
+    m_gcStats.freedObjects++;
+    if (node->isBuffered())
     {
-        std::get<FunctionValue>(func.value)(this);
+        node->setDead(true);
+        return;
     }
-    else
+    _deleteObject(node);
+}
+
+void GobLang::Machine::_deleteObject(MemoryNode *node)
+{
+    m_memory.erase(node);
+    if (node->isInterned())
     {
-        throw RuntimeException("Attempted to call a function, but top of the stack doesn't contain a function");
+        _unintern(static_cast<StringNode *>(node));
     }
+    _destroyObject(node);
 }
 
-void GobLang::Machine::_pushConstInt()
+void GobLang::Machine::_unintern(StringNode *node)
 {
-    m_operationStack.push_back(MemoryValue{.type = Type::Int, .value = m_constInts[(size_t)m_operations[m_programCounter + 1]]});
-    m_programCounter++;
+    // every write removes the string from the index first, so it is still stored under its current contents
+    m_stringIndex.erase(node->getString());
+    node->setInterned(false);
 }
 
-void GobLang::Machine::_pushConstChar()
+void GobLang::Machine::_destroyObject(MemoryNode *node)
 {
-    m_operationStack.push_back(MemoryValue{.type = Type::Char, .value = (char)m_operations[m_programCounter + 1]});
-    m_programCounter++;
+    size_t size = getAllocationSize(node);
+    node->~MemoryNode();
+    m_pool.free(node, size);
 }
 
-void GobLang::Machine::_pushConstString()
+GobLang::Machine::~Machine()
 {
-    MemoryNode *root = m_memoryRoot;
-    std::string &str = m_constStrings[(size_t)m_operations[m_programCounter + 1]];
-    // we always create a new string object because otherwise each variable will share same pointer to constant string which can be altered
-    StringNode *node = createString(str, true);
-
-    m_programCounter++;
-    m_operationStack.push_back(MemoryValue{.type = Type::MemoryObj, .value = node});
+    for (std::pair<const size_t, JitLoop *> &loop : m_jitLoops)
+    {
+        delete loop.second;
+    }
+    _destroyAllObjects();
 }
 
-void GobLang::Machine::_getArray()
+void GobLang::Machine::_destroyAllObjects()
 {
-    MemoryValue index = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue array = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (!std::holds_alternative<MemoryNode *>(array.value))
+    if (m_gcMode == GarbageCollectorMode::Region)
     {
-        throw RuntimeException(std::string("Attempted to get array value, but array has instead type: ") + typeToString(array.type));
+        for (MemoryNode *node : m_regionOwners)
+        {
+            _destroyObject(node);
+        }
+        m_regionOwners.clear();
+        m_pool.rewind();
     }
-    if (!std::holds_alternative<int32_t>(index.value))
+    else
     {
-        throw RuntimeException(std::string("Attempted to get array value, but index has instead type: ") + typeToString(array.type));
+        MemoryNode *root = m_memory.getFirst();
+        while (root != nullptr)
+        {
+            MemoryNode *del = root;
+            root = root->getNext();
+            _destroyObject(del);
+        }
     }
-    if (ArrayNode *arrNode = dynamic_cast<ArrayNode *>(std::get<MemoryNode *>(array.value)); arrNode != nullptr)
+    m_memory.clear();
+    m_stringIndex.clear();
+    m_nursery.clear();
+    m_zeroCountTable.clear();
+    m_cycleRoots.clear();
+    m_gcInProgress = false;
+    m_sweepCursor = nullptr;
+    m_sweepEnd = nullptr;
+    m_allocatedBytes = 0;
+    m_allocationLimit = GC_ALLOCATION_THRESHOLD;
+}
+
+void GobLang::Machine::reset()
+{
+    _destroyAllObjects();
+    for (std::map<std::string, MemoryValue>::iterator it = m_globals.begin(); it != m_globals.end();)
     {
-        m_operationStack.push_back(*arrNode->getItem(std::get<int32_t>(index.value)));
+        it = it->second.getType() == Type::MemoryObj ? m_globals.erase(it) : std::next(it);
     }
-    else if (StringNode *strNode = dynamic_cast<StringNode *>(std::get<MemoryNode *>(array.value)); strNode != nullptr)
+    std::fill(m_variables.begin(), m_variables.end(), MemoryValue::makeNull());
+    m_localVariableCount = 0;
+    m_operationStackSize = 0;
+    m_programCounter = 0;
+    m_forcedEnd = false;
+    m_failed = false;
+    m_errorMessage.clear();
+}
+
+GobLang::ProgramAddressType GobLang::Machine::_getAddressFromByteCode(size_t start)
+{
+    ProgramAddressType reconAddr = 0x0;
+    for (int32_t i = 0; i < sizeof(ProgramAddressType); i++)
     {
-        m_operationStack.push_back(MemoryValue{.type = Type::Char, .value = strNode->getCharAt(std::get<int32_t>(index.value))});
+        ProgramAddressType offset = (sizeof(ProgramAddressType) - i - 1) * 8;
+        reconAddr |= (ProgramAddressType)(m_operations[start + i]) << offset;
     }
+    return reconAddr;
 }
 
-void GobLang::Machine::_setArray()
+void GobLang::Machine::_set()
 {
-    MemoryValue index = m_operationStack[m_operationStack.size() - 3];
-    MemoryValue array = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue value = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (!std::holds_alternative<MemoryNode *>(array.value))
+    // (name val =)
+    MemoryValue val = _stackBase()[m_operationStackSize - 1];
+    MemoryValue name = _stackBase()[m_operationStackSize - 2];
+    popStack();
+    popStack();
+    StringNode *memStr = name.getType() == Type::MemoryObj ? memoryCast<StringNode>(name.getObject()) : nullptr;
+    if (memStr != nullptr)
     {
-        throw RuntimeException(std::string("Attempted to set array value, but array has instead type: ") + typeToString(array.type));
+        setGlobal(memStr->getString(), val);
     }
-    if (!std::holds_alternative<int32_t>(index.value))
+}
+
+void GobLang::Machine::setGlobal(std::string const &name, MemoryValue const &val)
+{
+    MemoryValue stored = _promote(val);
+    if (m_gcMode != GarbageCollectorMode::ReferenceCounting)
     {
-        throw RuntimeException(std::string("Attempted to set array value, but index has instead type: ") + typeToString(array.type));
+        m_globals[name] = stored;
+        return;
     }
-    MemoryNode *m = std::get<MemoryNode *>(array.value);
-    if (ArrayNode *arrNode = dynamic_cast<ArrayNode *>(m); arrNode != nullptr)
+    if (stored.getType() == Type::MemoryObj)
     {
-        arrNode->setItem(std::get<int32_t>(index.value), value);
+        stored.getObject()->increaseRefCount();
     }
-    else if (StringNode *strNode = dynamic_cast<StringNode *>(m); strNode != nullptr && value.type == Type::Char)
+    std::map<std::string, MemoryValue>::iterator it = m_globals.find(name);
+    if (it != m_globals.end() && it->second.getType() == Type::MemoryObj)
     {
-        strNode->setCharAt(std::get<char>(value.value), std::get<int32_t>(index.value));
+        it->second.getObject()->decreaseRefCount();
+        _releaseObject(it->second.getObject());
     }
+    m_globals[name] = stored;
 }
 
-void GobLang::Machine::_eq()
+GobLang::MemoryValue GobLang::Machine::getGlobal(std::string const &name)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (a.type == b.type)
-    {
-        m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = areEqual(a, b)});
-    }
-    else
+    std::map<std::string, MemoryValue>::iterator it = m_globals.find(name);
+    if (it == m_globals.end())
     {
-        throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.type) + " and " + typeToString(b.type));
+        throw RuntimeException(std::string("Attempted to get variable '" + name + "', which doesn't exist"));
     }
+    return it->second;
 }
 
-void GobLang::Machine::_neq()
+void GobLang::Machine::_get()
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (a.type != b.type)
-    {
-        throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.type) + " and " + typeToString(b.type));
-    }
-    else
+    MemoryValue name = _stackBase()[m_operationStackSize - 1];
+    popStack();
+    assert(name.getType() == Type::MemoryObj);
+    StringNode *memStr = memoryCast<StringNode>(name.getObject());
+    if (memStr != nullptr)
     {
-        m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = !areEqual(a, b)});
+        pushToStack(getGlobal(memStr->getString()));
     }
 }
 
-void GobLang::Machine::_and()
+void GobLang::Machine::_call(size_t argCount)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (a.type != b.type && a.type != Type::Bool)
-    {
-        throw RuntimeException(std::string("Attempted to 'and' values of ") + typeToString(a.type) + " and " + typeToString(b.type));
-    }
-    else
-    {
-        m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<bool>(a.value) && std::get<bool>(b.value)});
-    }
+    MemoryValue func = _stackBase()[m_operationStackSize - 1];
+    popStack();
+    pushToStack(callFunction(func, argCount));
 }
 
-void GobLang::Machine::_or()
+GobLang::MemoryValue GobLang::Machine::callFunction(MemoryValue const &func, size_t argCount)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (a.type != b.type && a.type != Type::Bool)
+    if (func.getType() != Type::NativeFunction)
     {
-        throw RuntimeException(std::string("Attempted to 'or' values of ") + typeToString(a.type) + " and " + typeToString(b.type));
-    }
-    else
-    {
-        m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<bool>(a.value) || std::get<bool>(b.value)});
+        throw RuntimeException("Attempted to call a function, but top of the stack doesn't contain a function");
     }
+    return callNative(func.getNativeFunction(), argCount);
 }
 
-void GobLang::Machine::_less()
+GobLang::MemoryValue GobLang::Machine::callNative(size_t id, size_t argCount)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (a.type != b.type)
+    // make sure that pushing the result doesn't move the stack and invalidate the arguments
+    if (m_operationStackSize + 1 == m_operationStack.size())
     {
-        throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.type) + " and " + typeToString(b.type));
-    }
-    else
-    {
-        switch (a.type)
-        {
-        case Type::Int:
-            m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<int32_t>(a.value) < std::get<int32_t>(b.value)});
-            break;
-        case Type::Number:
-            m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<float>(a.value) < std::get<int32_t>(b.value)});
-            break;
-        default:
-            throw RuntimeException(std::string("Attempted to compare value of type ") + typeToString(a.type) + ". Only numeric types can be compared using >,<, <=, >=");
-        }
+        _growOperationStack();
     }
+    size_t base = m_operationStackSize - argCount;
+    NativeRegistry::Entry const &entry = m_natives.get(id);
+    entry.function(this, NativeArguments(_stackBase() + base, argCount, entry.name.c_str()), entry.userData);
+    // arguments are removed in one go, anything that function left on the stack above them is discarded except for the last value which is the result
+    MemoryValue result = m_operationStackSize > base ? _stackBase()[m_operationStackSize - 1] : MemoryValue::makeNull();
+    m_operationStackSize = base;
+    return result;
+}
+
+void GobLang::Machine::_pushConstString(size_t id)
+{
+    // every push creates a new string object, because variables assigned from different evaluations must not see each other's writes.
+    // Characters of the constant are shared and only copied once something writes into the string
+    StringNode *node = _createYoungString(m_constStrings[id]);
+    pushToStack(MemoryValue::makeObject(node));
+}
+
+void GobLang::Machine::_getArray()
+{
+    MemoryValue index = _stackBase()[m_operationStackSize - 2];
+    MemoryValue array = _stackBase()[m_operationStackSize - 1];
+    popStack();
+    popStack();
+    pushToStack(getArrayItem(array, index));
 }
 
-void GobLang::Machine::_more()
+GobLang::MemoryValue GobLang::Machine::getArrayItem(MemoryValue const &array, MemoryValue const &index)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (a.type != b.type)
+    if (array.getType() != Type::MemoryObj)
     {
-        throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.type) + " and " + typeToString(b.type));
+        throw RuntimeException(std::string("Attempted to get array value, but array has instead type: ") + typeToString(array.getType()));
     }
-    else
+    if (index.getType() != Type::Int)
     {
-        switch (a.type)
-        {
-        case Type::Int:
-            m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<int32_t>(a.value) > std::get<int32_t>(b.value)});
-            break;
-        case Type::Number:
-            m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<float>(a.value) > std::get<int32_t>(b.value)});
-            break;
-        default:
-            throw RuntimeException(std::string("Attempted to compare value of type ") + typeToString(a.type) + ". Only numeric types can be compared using >,<, <=, >=");
-        }
+        throw RuntimeException(std::string("Attempted to get array value, but index has instead type: ") + typeToString(array.getType()));
+    }
+    MemoryNode *m = array.getObject();
+    switch (m->getKind())
+    {
+    case MemoryKind::Array:
+        return *static_cast<ArrayNode *>(m)->getItem(index.getInt());
+    case MemoryKind::String:
+        return MemoryValue::makeChar(static_cast<StringNode *>(m)->getCharAt(index.getInt()));
+    default:
+        break;
     }
+    throw RuntimeException("Attempted to get array value, but object is not an array or a string");
+}
+
+void GobLang::Machine::_setArray()
+{
+    MemoryValue index = _stackBase()[m_operationStackSize - 3];
+    MemoryValue array = _stackBase()[m_operationStackSize - 2];
+    MemoryValue value = _stackBase()[m_operationStackSize - 1];
+    popStack();
+    popStack();
+    popStack();
+    setArrayItem(array, index, value);
 }
 
-void GobLang::Machine::_lessOrEq()
+void GobLang::Machine::_setStringChar(StringNode *str, char ch, size_t index)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (a.type != b.type)
+    // string with different contents must not be found by the search for the old ones
+    if (str->isInterned())
     {
-        throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.type) + " and " + typeToString(b.type));
+        _unintern(str);
     }
-    else
+    bool wasShared = str->isShared();
+    str->setCharAt(ch, index);
+    // copy made for the write may own memory that rewinding the pool doesn't free. Nursery strings are destroyed by the nursery itself
+    if (wasShared && m_gcMode == GarbageCollectorMode::Region && !m_nursery.contains(str) && ownsExternalMemory(str))
     {
-        switch (a.type)
-        {
-        case Type::Int:
-            m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<int32_t>(a.value) <= std::get<int32_t>(b.value)});
-            break;
-        case Type::Number:
-            m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<float>(a.value) <= std::get<int32_t>(b.value)});
-            break;
-        default:
-            throw RuntimeException(std::string("Attempted to compare value of type ") + typeToString(a.type) + ". Only numeric types can be compared using >,<, <=, >=");
-        }
+        m_regionOwners.push_back(str);
     }
 }
 
-void GobLang::Machine::_moreOrEq()
+void GobLang::Machine::setArrayItem(MemoryValue const &array, MemoryValue const &index, MemoryValue const &value)
 {
-    MemoryValue a = m_operationStack[m_operationStack.size() - 2];
-    MemoryValue b = m_operationStack[m_operationStack.size() - 1];
-    m_operationStack.pop_back();
-    m_operationStack.pop_back();
-    if (a.type != b.type)
+    if (array.getType() != Type::MemoryObj)
     {
-        throw RuntimeException(std::string("Attempted to compare value of ") + typeToString(a.type) + " and " + typeToString(b.type));
+        throw RuntimeException(std::string("Attempted to set array value, but array has instead type: ") + typeToString(array.getType()));
     }
-    else
+    if (index.getType() != Type::Int)
     {
-        switch (a.type)
+        throw RuntimeException(std::string("Attempted to set array value, but index has instead type: ") + typeToString(array.getType()));
+    }
+    MemoryNode *m = array.getObject();
+    switch (m->getKind())
+    {
+    case MemoryKind::Array:
+    {
+        ArrayNode *arr = static_cast<ArrayNode *>(m);
+        MemoryValue stored = _promote(value);
+        if (m_gcMode != GarbageCollectorMode::ReferenceCounting)
         {
-        case Type::Int:
-            m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<int32_t>(a.value) >= std::get<int32_t>(b.value)});
-            break;
-        case Type::Number:
-            m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = std::get<float>(a.value) >= std::get<int32_t>(b.value)});
+            *arr->getItem(index.getInt()) = stored;
             break;
-        default:
-            throw RuntimeException(std::string("Attempted to compare value of type ") + typeToString(a.type) + ". Only numeric types can be compared using >,<, <=, >=");
         }
-    }
-}
-
-void GobLang::Machine::_negate()
-{
-    MemoryValue val = *m_operationStack.rbegin();
-    m_operationStack.pop_back();
-    switch (val.type)
-    {
-    case Type::Int:
-        m_operationStack.push_back(MemoryValue{.type = Type::Int, .value = -std::get<int32_t>(val.value)});
+        MemoryValue old = *arr->getItem(index.getInt());
+        arr->setItem(index.getInt(), stored);
+        if (old.getType() == Type::MemoryObj)
+        {
+            _releaseObject(old.getObject());
+        }
         break;
-    case Type::Number:
-        m_operationStack.push_back(MemoryValue{.type = Type::Number, .value = -std::get<float>(val.value)});
+    }
+    case MemoryKind::String:
+        if (value.getType() == Type::Char)
+        {
+            _setStringChar(static_cast<StringNode *>(m), value.getChar(), index.getInt());
+        }
         break;
     default:
-        throw RuntimeException("Attempted to apply negate operation on a non numeric value");
-    }
-}
-
-void GobLang::Machine::_not()
-{
-    MemoryValue val = *m_operationStack.rbegin();
-    m_operationStack.pop_back();
-    if (val.type != Type::Bool)
-    {
-        throw RuntimeException("Attempted to negate non boolean value");
+        break;
     }
-    m_operationStack.push_back(MemoryValue{.type = Type::Bool, .value = !std::get<bool>(val.value)});
-}
-
-void GobLang::Machine::_shrink()
-{
-    m_programCounter++;
-    size_t amount = (size_t)m_operations[m_programCounter];
-    shrinkLocalVariableStackBy(amount);
 }
@@ -1,10 +1,14 @@
 #pragma once
 #include <map>
+#include <deque>
 #include <vector>
 #include <cstdint>
 #include <string>
 #include <cassert>
 #include <exception>
+#include <chrono>
+#include <string_view>
+#include <unordered_map>
 
 #include "Type.hpp"
 #include "Memory.hpp"
@@ -12,6 +16,10 @@
 #include "Value.hpp"
 #include "Array.hpp"
 #include "Exception.hpp"
+#include "Jit.hpp"
+#include "NativeRegistry.hpp"
+#include "Nursery.hpp"
+#include "MemoryPool.hpp"
 #include "../compiler/ByteCode.hpp"
 
 namespace GobLang
@@ -21,23 +29,115 @@ namespace GobLang
      *
      */
     using ProgramAddressType = size_t;
+
+    /**
+     * @brief Result of running the machine with a budget
+     *
+     */
+    enum class RunStatus
+    {
+        /**
+         * @brief Program reached the end
+         */
+        Finished,
+        /**
+         * @brief Budget ran out before the program finished, calling `run` again continues from where it stopped
+         */
+        BudgetExhausted,
+        /**
+         * @brief Program stopped because of an error, message is available via `getErrorMessage`
+         */
+        Error
+    };
+
+    /**
+     * @brief How the machine finds objects that are no longer used
+     *
+     */
+    enum class GarbageCollectorMode
+    {
+        /**
+         * @brief Stores update reference counts, objects that drop to zero are deleted in batches and cycles are found by trial deletion
+         */
+        ReferenceCounting,
+        /**
+         * @brief Stores don't touch reference counts. Once enough memory is allocated everything reachable from
+         * the operation stack, local variables and globals is marked and the rest is deleted
+         */
+        Tracing,
+        /**
+         * @brief Stores don't touch reference counts and nothing is deleted while the program runs.
+         * All objects are released at once when the machine is destroyed or reset, meant for short programs that run on a fresh machine
+         */
+        Region
+    };
+
+    /**
+     * @brief Counters describing the work done by the garbage collector
+     *
+     */
+    struct GarbageCollectorStats
+    {
+        /**
+         * @brief How many times the zero count table was processed
+         */
+        size_t collections = 0;
+        /**
+         * @brief How many times the cycle collector ran
+         */
+        size_t cycleCollections = 0;
+        /**
+         * @brief Objects deleted because their reference count dropped to zero
+         */
+        size_t freedObjects = 0;
+        /**
+         * @brief Objects deleted by the cycle collector
+         */
+        size_t freedCycleObjects = 0;
+        /**
+         * @brief How many times the nursery was cleared
+         */
+        size_t nurseryCollections = 0;
+        /**
+         * @brief Nursery strings that were copied to the heap, because they were stored or were still in use when the nursery was cleared
+         */
+        size_t promotedObjects = 0;
+        /**
+         * @brief Time spent in all collections
+         */
+        std::chrono::nanoseconds totalPause = std::chrono::nanoseconds::zero();
+        /**
+         * @brief Time spent in the longest collection
+         */
+        std::chrono::nanoseconds longestPause = std::chrono::nanoseconds::zero();
+    };
+
     class Machine
     {
     public:
-        explicit Machine()
+        explicit Machine(GarbageCollectorMode gcMode = GarbageCollectorMode::ReferenceCounting) : m_gcMode(gcMode)
         {
         }
 
-        explicit Machine(Compiler::ByteCode const &code);
+        /**
+         * @brief Construct a new Machine object
+         *
+         * @param code Byte code to run
+         * @param natives Native functions available to the code, usually the same registry that was given to the compiler
+         * @param gcMode How unused objects are found, can't be changed once the machine is created
+         */
+        explicit Machine(Compiler::ByteCode const &code, NativeRegistry const &natives = NativeRegistry(), GarbageCollectorMode gcMode = GarbageCollectorMode::ReferenceCounting);
 
         void addOperation(Operation op)
         {
             m_operations.push_back((uint8_t)op);
+            m_operationsPrepared = false;
         }
 
         void addUInt8(uint8_t val)
         {
             m_operations.push_back(val);
+            m_operationsPrepared = false;
         }
 
         void addStringConst(std::string const &str)
@@ -50,6 +150,11 @@ namespace GobLang
             m_constInts.push_back(val);
         }
 
+        /**
+         * @brief Get index of the next instruction to execute. Once operations are prepared this is an index into decoded instructions rather than a byte offset
+         *
+         * @return size_t Index of the instruction
+         */
         size_t getProgramCounter() const
         {
             return m_programCounter;
@@ -57,11 +162,82 @@ namespace GobLang
 
         bool isAtTheEnd() const
         {
-            return m_programCounter >= m_operations.size() || m_forcedEnd;
+            return m_forcedEnd || (m_operationsPrepared ? m_programCounter >= m_instructions.size() : m_operations.empty());
         }
+        /**
+         * @brief Add a native function stored in `std::function`. Calls go through an extra indirection, prefer `addNativeFunction`
+         *
+         * @param func Function to call
+         * @param name Name of the global variable that will hold the function
+         */
         void addFunction(FunctionValue const &func, std::string const &name);
+
+        /**
+         * @brief Add a native function. Calls to it that were compiled into `CallNative` are bound by name
+         *
+         * @param func Function to call
+         * @param name Name of the global variable that will hold the function
+         * @param userData Pointer that is passed to every call of the function
+         */
+        void addNativeFunction(NativeFunctionPointer func, std::string const &name, void *userData = nullptr);
+
+        /**
+         * @brief Find id of the native function with the given name
+         *
+         * @return int64_t Id that can be passed to `callNative` or -1 if there is no such function
+         */
+        int64_t findNativeFunction(std::string const &name) const { return m_natives.find(name); }
+
+        /**
+         * @brief Execute a single operation. Useful for debugging, use `run` for normal execution
+         *
+         */
         void step();
 
+        /**
+         * @brief Execute operations until the end of the program is reached.
+         * Program counter and stack pointer are kept in locals and operations are dispatched directly from one handler to the next
+         *
+         */
+        void run();
+
+        /**
+         * @brief Execute operations until the end of the program is reached or the budget runs out.
+         * Budget is only checked at safepoints: every backward jump takes the length of the loop in instructions out of the budget and every call takes 1.
+         * Errors are not thrown, instead machine stops and every following call returns `RunStatus::Error`
+         *
+         * @param budget Approximate amount of instructions that can be executed before returning
+         * @return RunStatus Why execution stopped
+         */
+        RunStatus run(size_t budget);
+
+        /**
+         * @brief Get message of the error that stopped execution started by `run(budget)`
+         *
+         */
+        std::string const &getErrorMessage() const { return m_errorMessage; }
+
+        /**
+         * @brief Enable or disable compilation of hot loops into native code. Has no effect if JIT is not available on this platform
+         *
+         * @param enabled If true loops will be compiled
+         */
+        void setJitEnabled(bool enabled)
+        {
+#ifdef GOB_JIT_AVAILABLE
+            m_jitEnabled = enabled;
+#endif
+        }
+
+        bool isJitEnabled() const { return m_jitEnabled; }
+
+        /**
+         * @brief Get amount of loops that were compiled into native code
+         *
+         * @return size_t Amount of compiled loops
+         */
+        size_t getCompiledLoopCount() const;
+
         void printGlobalsInfo();
 
         void printVariablesInfo();
@@ -70,8 +246,6 @@ namespace GobLang
 
         MemoryValue *getStackTop();
 
-        MemoryValue *getStackTopAndPop();
-
         ArrayNode *createArrayOfSize(int32_t size);
 
         /**
@@ -79,8 +253,8 @@ namespace GobLang
          * 
          * @param str Base string to store in memory
          * @param alwaysNew If true that means that it will skip search and always create new memory object. 
-         * This is useful to avoid messing variables that were set from constants
-         * @return StringNode* Pointer to new string object or other string object that was found in memory
+         * This is useful to avoid messing variables that were set from constants. Only strings created without this flag can be found by the search
+         * @return StringNode* Pointer to new string object or other string object that was found in the string index
          */
         StringNode *createString(std::string const &str, bool alwaysNew = false);
 
@@ -108,6 +282,72 @@ namespace GobLang
 
         void shrinkLocalVariableStackBy(size_t size);
 
+        /**
+         * @brief Make sure that storage for local variables has space for the given amount of variables.
+         * Pointers returned by `getLocalVariableValue` stay valid as long as code doesn't address variables past that amount
+         *
+         * @param count Amount of local variables
+         */
+        void reserveLocalVariables(size_t count);
+
+        /**
+         * @brief Get value of the global variable
+         *
+         * @param name Name of the variable
+         * @return MemoryValue Value of the variable. Throws RuntimeException if variable doesn't exist
+         */
+        MemoryValue getGlobal(std::string const &name);
+
+        /**
+         * @brief Set value of the global variable and update reference counts of old and new value
+         *
+         * @param name Name of the variable
+         * @param val New value
+         */
+        void setGlobal(std::string const &name, MemoryValue const &val);
+
+        /**
+         * @brief Call a function with arguments that are already on the stack. Arguments are removed from the stack once function returns
+         *
+         * @param func Function to call
+         * @param argCount Amount of arguments on the stack
+         * @return MemoryValue Value returned by the function or null if function didn't return anything
+         */
+        MemoryValue callFunction(MemoryValue const &func, size_t argCount);
+
+        /**
+         * @brief Call a native function with arguments that are already on the stack. Arguments are removed from the stack once function returns
+         *
+         * @param id Id of the native function
+         * @param argCount Amount of arguments on the stack
+         * @return MemoryValue Value returned by the function or null if function didn't return anything
+         */
+        MemoryValue callNative(size_t id, size_t argCount);
+
+        /**
+         * @brief Get value stored in the array or string at the given index
+         *
+         * @param array Array or string object
+         * @param index Index of the item
+         * @return MemoryValue Value of the item
+         */
+        MemoryValue getArrayItem(MemoryValue const &array, MemoryValue const &index);
+
+        /**
+         * @brief Set value of an item in array or a character in string
+         *
+         * @param array Array or string object
+         * @param index Index of the item
+         * @param value New value
+         */
+        void setArrayItem(MemoryValue const &array, MemoryValue const &index, MemoryValue const &value);
+
+        /**
+         * @brief Get decoded and verified instructions of the program
+         *
+         */
+        std::vector<Instruction> const &getInstructions() const { return m_instructions; }
+
         /**
          * @brief Create a custom variable that will be accessible in code. Useful for binding with c code
          *
@@ -116,81 +356,483 @@ namespace GobLang
          */
         void createVariable(std::string const &name, MemoryValue const &value);
 
+        /**
+         * @brief Delete objects from the zero count table that are not referenced by anything.
+         * Values on the operation stack and in registers don't change reference counts, so objects they point to are kept until the next collection.
+         * In tracing mode marks every object reachable from the operation stack, local variables and globals and deletes the rest.
+         * If budget is set, only deletes that many objects and continues on the next call
+         *
+         */
         void collectGarbage();
 
+        /**
+         * @brief Delete cycles of arrays that are only referenced by each other. Uses synchronous trial deletion:
+         * arrays that lost a reference but are still in use are remembered as possible roots of a cycle, references inside the graph reachable from them
+         * are subtracted from reference counts and anything that ends up with no references from outside of the graph is deleted.
+         * Runs automatically once the amount of objects doubles since the last run. Does nothing in tracing mode, where every collection deletes cycles
+         *
+         */
+        void collectCycles();
+
+        GarbageCollectorMode getGarbageCollectorMode() const { return m_gcMode; }
+
+        GarbageCollectorStats const &getGarbageCollectorStats() const { return m_gcStats; }
+
+        /**
+         * @brief Collect garbage if enough objects lost their last reference since the last collection
+         * or, in tracing mode, if enough memory was allocated since the last collection.
+         * This is what the machine calls after every store, so it only costs a compare most of the time
+         *
+         */
+        void collectGarbageIfNeeded()
+        {
+            if (_isCollectionNeeded())
+            {
+                _collectGarbageAtSafepoint();
+            }
+        }
+
+        /**
+         * @brief Limit the amount of objects a single collection can delete. Collection that runs out of budget continues at the next safepoint,
+         * so dropping a large structure doesn't stall the program. Marking in tracing mode and the cycle collector still run in one go
+         *
+         * @param budget Amount of objects deleted per collection, 0 means no limit
+         */
+        void setGarbageCollectorBudget(size_t budget) { m_gcBudget = budget; }
+
+        size_t getGarbageCollectorBudget() const { return m_gcBudget; }
+
+        /**
+         * @brief Check if the last collection ran out of budget and has work left. Calling `collectGarbage` continues it
+         *
+         */
+        bool isCollectingGarbage() const { return m_gcInProgress; }
+
+        /**
+         * @brief Get amount of objects that are currently owned by the machine. Strings in the nursery are not counted
+         *
+         */
+        size_t getObjectCount() const { return m_memory.getSize(); }
+
+        /**
+         * @brief Delete every object and rewind to the start of the program, so that the same machine can run it again.
+         * Operation stack and local variables are cleared, globals that hold objects are removed, other globals and native functions stay
+         *
+         */
+        void reset();
+
         ~Machine();
 
     private:
         ProgramAddressType _getAddressFromByteCode(size_t start);
 
-        void _jump();
+        /**
+         * @brief Main interpreter loop shared by `run` and `step`
+         *
+         * @tparam SingleStep If true only one operation will be executed
+         * @param budget Amount of instructions that can be executed, checked only at safepoints
+         * @return RunStatus `Finished` if the loop stopped because of the end of the program or a single step, `BudgetExhausted` otherwise
+         */
+        template <bool SingleStep>
+        RunStatus _execute(int64_t budget);
+
+        /**
+         * @brief Decode the byte code into instruction records, making sure that every operation code is known,
+         * that jumps point to the start of an operation and that the instructions end with `End`.
+         * Decoded instructions are then checked by the `Verifier`, which allows the interpreter loop to skip bounds, stack and op code checks
+         *
+         */
+        void _prepareOperations();
+
+        /**
+         * @brief Run compiled version of the loop closed by the given jump, compiling it first if needed
+         *
+         * @param jumpId Index of the backward jump instruction
+         * @param budget Remaining budget, decreased on every iteration of the compiled loop
+         * @param resumeAt Index of the instruction to continue interpreting from
+         * @return true Loop was executed in native code
+         * @return false Loop can't be compiled or can't be entered with the current state, interpreter should execute the jump
+         */
+        bool _runJitLoop(size_t jumpId, int64_t &budget, size_t &resumeAt);
 
-        void _jumpIf();
+        /**
+         * @brief Double the size of the operation stack storage
+         *
+         */
+        void _growOperationStack();
 
-        void _addInt();
+        /**
+         * @brief Make sure that operation stack has space for the deepest stack the program can produce on top of values that are already there
+         *
+         */
+        void _reserveOperationStack();
 
-        void _subInt();
+        /**
+         * @brief Get pointer to the first value of the operation stack, which is located after the reserved slot
+         *
+         */
+        MemoryValue *_stackBase() { return m_operationStack.data() + 1; }
 
         void _set();
 
         void _get();
 
-        void _setLocal();
-
-        void _getLocal();
+        void _call(size_t argCount);
 
-        void _call();
+        /**
+         * @brief Get id of the native function that the id from the byte code native table is bound to.
+         * Throws RuntimeException if no function with that name was added
+         *
+         */
+        size_t _getBoundNative(size_t id) const;
 
-        void _pushConstInt();
+        /**
+         * @brief Resolve names from the byte code native table to ids of added native functions
+         *
+         */
+        void _bindNatives();
 
-        void _pushConstChar();
+        /**
+         * @brief Native function that calls `std::function` passed as user data
+         *
+         */
+        static void _callFunctionObject(Machine *machine, NativeArguments const &args, void *userData);
 
-        void _pushConstString();
+        /**
+         * @brief Push a new string object created from the string constant
+         *
+         * @param id Id of the string constant
+         */
+        void _pushConstString(size_t id);
 
         void _getArray();
 
         void _setArray();
 
-        void _eq();
+        /**
+         * @brief Write a character into the string, keeping the string index and region owners up to date
+         *
+         */
+        void _setStringChar(StringNode *str, char ch, size_t index);
 
-        void _neq();
+        bool _isCollectionNeeded() const
+        {
+            return m_nursery.isFull() || _isHeapCollectionNeeded();
+        }
 
-        void _and();
+        bool _isHeapCollectionNeeded() const
+        {
+            switch (m_gcMode)
+            {
+            case GarbageCollectorMode::Tracing:
+                return m_allocatedBytes >= m_allocationLimit;
+            case GarbageCollectorMode::Region:
+                return false;
+            default:
+                return m_zeroCountTable.size() >= m_zeroCountLimit;
+            }
+        }
 
-        void _or();
+        /**
+         * @brief Clear the nursery if it is full and collect garbage if needed. Called at safepoints, where every value is either on the operation stack or in variables
+         *
+         */
+        void _collectGarbageAtSafepoint();
 
-        void _less();
+        /**
+         * @brief Create a string for a string constant in the nursery, or on the heap if the nursery is full.
+         * String shares characters of the constant until something writes into it
+         *
+         * @param constant Element of `m_constStrings`
+         */
+        StringNode *_createYoungString(std::string const &constant);
 
-        void _more();
+        /**
+         * @brief Create a string on the heap that shares characters of the string constant
+         *
+         */
+        StringNode *_createSharedString(std::string const *constant);
 
-        void _lessOrEq();
+        /**
+         * @brief Get value that can be stored in a variable or an array. Nursery strings are moved to the heap, other values are returned as is.
+         * Only the node is copied if the string still shares characters of a constant
+         *
+         */
+        MemoryValue _promote(MemoryValue const &val);
+
+        /**
+         * @brief Move nursery strings that are still on the operation stack or in registers to the heap and clear the nursery
+         *
+         */
+        void _evacuateNursery();
 
-        void _moreOrEq();
+        /**
+         * @brief Take ownership of the new object. Object has no references yet, so it starts in the zero count table
+         *
+         */
+        void _registerObject(MemoryNode *node);
 
-        void _negate();
+        /**
+         * @brief Delete zero count table entries that are not referenced by anything
+         *
+         */
+        void _collectZeroCountTable();
 
-        void _not();
+        /**
+         * @brief Mark objects reachable from the operation stack, local variables and globals and start sweeping
+         *
+         */
+        void _markReachable();
 
-        void _shrink();
+        /**
+         * @brief Delete unmarked objects that existed when marking finished, until the budget runs out
+         *
+         */
+        void _sweep();
+
+        /**
+         * @brief Put the object into the zero count table if its reference count dropped to zero
+         *
+         */
+        void _releaseObject(MemoryNode *node);
+
+        /**
+         * @brief Set or clear the mark of objects referenced by values that are not reference counted: operation stack and registers
+         *
+         */
+        void _markRoots(bool marked);
+
+        /**
+         * @brief Release objects referenced by the object and delete it. Objects in the cycle root buffer are only marked as dead
+         * and deleted by the cycle collector once it removes them from the buffer
+         *
+         */
+        void _freeObject(MemoryNode *node);
+
+        /**
+         * @brief Remove the object from memory and delete it without touching any reference counts
+         *
+         */
+        void _deleteObject(MemoryNode *node);
+
+        /**
+         * @brief Remove the string from the string index
+         *
+         */
+        void _unintern(StringNode *node);
+
+        /**
+         * @brief Call destructor of the object and give its memory back to the pool
+         *
+         */
+        void _destroyObject(MemoryNode *node);
+
+        /**
+         * @brief Delete every object without touching any reference counts. In region mode only objects that own memory outside of pool chunks
+         * are visited, the rest is freed by rewinding the pool
+         *
+         */
+        void _destroyAllObjects();
+
+        /**
+         * @brief Subtract references made by the graph reachable from the node and color the graph gray
+         *
+         */
+        void _markGray(MemoryNode *node);
+
+        /**
+         * @brief Color gray objects that have no references from outside of the graph white and restore counts of the rest
+         *
+         */
+        void _scan(MemoryNode *node);
+
+        /**
+         * @brief Restore reference counts of the graph reachable from the node and color it black
+         *
+         */
+        void _scanBlack(MemoryNode *node);
+
+        /**
+         * @brief Gather white objects reachable from the node
+         *
+         */
+        void _collectWhite(MemoryNode *node, std::vector<MemoryNode *> &garbage);
 
         bool m_forcedEnd = false;
 
-        MemoryNode *m_memoryRoot = new MemoryNode();
+        /**
+         * @brief Set once `run(budget)` stopped because of an error
+         *
+         */
+        bool m_failed = false;
+        std::string m_errorMessage;
+
+        /**
+         * @brief Set to true once operations have been checked by `_prepareOperations`
+         *
+         */
+        bool m_operationsPrepared = false;
+
+        /**
+         * @brief Memory for all objects created by the machine
+         *
+         */
+        MemoryPool m_pool;
+        /**
+         * @brief All objects created by the machine
+         *
+         */
+        MemoryList m_memory;
+        /**
+         * @brief Storage for strings created from constants. Values in variables, globals and arrays never point into it
+         *
+         */
+        Nursery m_nursery = Nursery(GC_NURSERY_SIZE);
+        /**
+         * @brief Objects that own memory outside of pool chunks, like long strings and large arrays. In region mode these are the only objects that are destroyed one by one
+         *
+         */
+        std::vector<MemoryNode *> m_regionOwners;
+        /**
+         * @brief Strings created by `createString` that can be returned instead of creating a new string with the same contents.
+         * Keys point to characters of the strings themselves, strings are removed once they are deleted or written to
+         *
+         */
+        std::unordered_map<std::string_view, StringNode *> m_stringIndex;
+        GarbageCollectorMode m_gcMode = GarbageCollectorMode::ReferenceCounting;
+        /**
+         * @brief Approximate amount of bytes allocated for objects since the last tracing collection
+         *
+         */
+        size_t m_allocatedBytes = 0;
+        /**
+         * @brief Amount of allocated bytes that triggers tracing collection. Grows with the amount of live memory, so that the cost of marking is spread over allocations
+         *
+         */
+        size_t m_allocationLimit = GC_ALLOCATION_THRESHOLD;
+        /**
+         * @brief Amount of objects a single collection can delete, 0 if there is no limit
+         *
+         */
+        size_t m_gcBudget = 0;
+        /**
+         * @brief Set if the last collection ran out of budget before it finished
+         *
+         */
+        bool m_gcInProgress = false;
+        /**
+         * @brief Next object to sweep in tracing mode, nullptr if sweeping is done
+         *
+         */
+        MemoryNode *m_sweepCursor = nullptr;
+        /**
+         * @brief Last object that existed when marking finished, objects after it are not swept
+         *
+         */
+        MemoryNode *m_sweepEnd = nullptr;
+        size_t m_sweepLiveBytes = 0;
+        /**
+         * @brief Objects whose reference count dropped to zero since the last collection. They are only candidates for deletion,
+         * because they might still be referenced by the operation stack or registers, or get a new reference before collection
+         *
+         */
+        std::vector<MemoryNode *> m_zeroCountTable;
+        /**
+         * @brief Size of the zero count table that triggers collection. Grows when many candidates survive collection,
+         * to avoid scanning the same live objects after every store
+         *
+         */
+        size_t m_zeroCountLimit = GC_ZERO_COUNT_THRESHOLD;
+        /**
+         * @brief Arrays that lost a reference but are still referenced by something, these are possible roots of garbage cycles
+         *
+         */
+        std::vector<MemoryNode *> m_cycleRoots;
+        /**
+         * @brief Amount of objects that triggers the cycle collector
+         *
+         */
+        size_t m_cycleLimit = GC_CYCLE_THRESHOLD;
+        /**
+         * @brief Work list used by the cycle collector and marking instead of recursion, so long chains of arrays can't overflow the stack
+         *
+         */
+        std::vector<MemoryNode *> m_cycleWork;
+        GarbageCollectorStats m_gcStats;
+
         size_t m_programCounter = 0;
         std::vector<uint8_t> m_operations;
-        std::vector<MemoryValue> m_operationStack;
+        /**
+         * @brief Operations decoded by `_prepareOperations`, this is what the interpreter loop actually runs
+         *
+         */
+        std::vector<Instruction> m_instructions;
+        /**
+         * @brief How many times each backward jump was executed, used to find loops that are worth compiling
+         *
+         */
+        std::vector<uint32_t> m_loopHits;
+        /**
+         * @brief Compiled loops, key is the index of the backward jump closing the loop
+         *
+         */
+        std::map<size_t, JitLoop *> m_jitLoops;
+#ifdef GOB_JIT_AVAILABLE
+        bool m_jitEnabled = true;
+#else
+        bool m_jitEnabled = false;
+#endif
+        /**
+         * @brief Storage for the operation stack. First slot is reserved, it lets the interpreter spill cached top of the stack
+         * without checking if stack is empty. Only `m_operationStackSize` values after it are in use,
+         * the rest is preallocated space that avoids resizing on every push
+         *
+         */
+        std::vector<MemoryValue> m_operationStack = std::vector<MemoryValue>(OPERATION_STACK_INITIAL_SIZE);
+        size_t m_operationStackSize = 0;
+        /**
+         * @brief Largest amount of values the program can put on the operation stack, calculated by the verifier
+         *
+         */
+        size_t m_maxStackDepth = 0;
         /**
          * @brief Special dictionary that can be written externally and internally which uses strings to identify variables.
          *
          * Any variable that doesn't have a valid local variable attached will attempt to read a global variable value
          */
         std::map<std::string, MemoryValue> m_globals;
+        /**
+         * @brief Native functions available to the code, function values store index into this table
+         *
+         */
+        NativeRegistry m_natives;
+        /**
+         * @brief Functions added via `addFunction`. Deque keeps their addresses stable, because they are passed as user data
+         *
+         */
+        std::deque<FunctionValue> m_functionObjects;
+        /**
+         * @brief Names of native functions called by `CallNative` and ids of the functions they are bound to, -1 if function was not added
+         *
+         */
+        std::vector<std::string> m_constNatives;
+        std::vector<int64_t> m_nativeBindings;
         /**
          * @brief Array of currently present local variables.
          *  These variables can only be addressed by their index and will be overriden once the id is used in a different block
          *
          */
         std::vector<MemoryValue> m_variables;
+        /**
+         * @brief Amount of local variables that are currently alive. In register based code `m_variables` also contains temporary registers after them
+         *
+         */
+        size_t m_localVariableCount = 0;
+        /**
+         * @brief Registers with ids lower than this are local variables, everything else is temporary values
+         *
+         */
+        size_t m_registerBase = 0;
         std::vector<int32_t> m_constInts;
         std::vector<float> m_constFloats;
         std::vector<std::string> m_constStrings;
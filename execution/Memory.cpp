@@ -1,78 +1,106 @@
 #include "Memory.hpp"
-void GobLang::MemoryNode::insert(MemoryNode *node)
+#include <memory>
+#include <new>
+void GobLang::MemoryNode::increaseRefCount()
 {
-    if (node != nullptr)
-    {
-        MemoryNode *prevNext = m_next;
-        m_next = node;
-        node->m_next = prevNext;
-    }
+    m_refCount++;
 }
 
-void GobLang::MemoryNode::eraseNext()
+void GobLang::MemoryNode::decreaseRefCount()
 {
-    if (m_next != nullptr)
-    {
-        m_next = m_next->m_next;
-    }
+    m_refCount--;
 }
 
-void GobLang::MemoryNode::pushBack(MemoryNode *node)
+void GobLang::MemoryList::pushBack(MemoryNode *node)
 {
-    if (node == nullptr)
+    node->m_prev = m_last;
+    node->m_next = nullptr;
+    if (m_last != nullptr)
     {
-        // don't pollute the memory
-        return;
+        m_last->m_next = node;
     }
-    MemoryNode *curr = this;
-    while (curr->m_next != nullptr)
+    else
     {
-        curr = curr->m_next;
+        m_first = node;
     }
-    curr->m_next = node;
+    m_last = node;
+    m_size++;
 }
 
-void GobLang::MemoryNode::increaseRefCount()
+void GobLang::MemoryList::erase(MemoryNode *node)
 {
-    m_refCount++;
+    if (node->m_prev != nullptr)
+    {
+        node->m_prev->m_next = node->m_next;
+    }
+    else
+    {
+        m_first = node->m_next;
+    }
+    if (node->m_next != nullptr)
+    {
+        node->m_next->m_prev = node->m_prev;
+    }
+    else
+    {
+        m_last = node->m_prev;
+    }
+    node->m_next = nullptr;
+    node->m_prev = nullptr;
+    m_size--;
 }
 
-void GobLang::MemoryNode::decreaseRefCount()
+void GobLang::MemoryList::clear()
 {
-    m_refCount--;
+    m_first = nullptr;
+    m_last = nullptr;
+    m_size = 0;
 }
 
-size_t GobLang::MemoryNode::length()
+bool GobLang::MemoryNode::equalsTo(MemoryNode *other)
 {
-    MemoryNode *curr = this->m_next;
-    size_t size = 1;
-    for (; curr != nullptr; curr = curr->m_next)
+    if (other == this)
+    {
+        return true;
+    }
+    if (m_kind == MemoryKind::String && other->m_kind == MemoryKind::String)
     {
-        size++;
+        return static_cast<StringNode *>(this)->getString() == static_cast<StringNode *>(other)->getString();
     }
-    return size;
+    return false;
 }
 
-bool GobLang::MemoryNode::equalsTo(MemoryNode *other)
+GobLang::StringNode::StringNode(std::string const &str) : MemoryNode(Kind)
+{
+    new (&m_str) std::string(str);
+}
+
+GobLang::StringNode::StringNode(std::string const *shared) : MemoryNode(Kind)
 {
-    return other == this;
+    m_sharedStr = shared;
+    m_shared = true;
 }
 
 char GobLang::StringNode::getCharAt(size_t ind)
 {
-    return m_str[ind];
+    return getString()[ind];
 }
 
 void GobLang::StringNode::setCharAt(char ch, size_t ind)
 {
+    if (m_shared)
+    {
+        std::string const *shared = m_sharedStr;
+        new (&m_str) std::string(*shared);
+        m_shared = false;
+    }
     m_str[ind] = ch;
 }
 
-bool GobLang::StringNode::equalsTo(MemoryNode *other)
+GobLang::StringNode::~StringNode()
 {
-    if (StringNode *otherStr = dynamic_cast<StringNode *>(other); otherStr != nullptr)
+    if (!m_shared)
     {
-        return otherStr->getString() == getString();
+        std::destroy_at(&m_str);
     }
-    return false;
 }
@@ -6,6 +6,44 @@
 #include "Type.hpp"
 namespace GobLang
 {
+    /**
+     * @brief Kind of the object stored in memory. Lets the machine identify built in objects with a single compare instead of `dynamic_cast`
+     *
+     */
+    enum class MemoryKind : uint8_t
+    {
+        /**
+         * @brief Plain node that is neither a string nor an array. Machine only allocates strings and arrays, so it never owns nodes of this kind
+         */
+        Object,
+        String,
+        Array,
+    };
+
+    /**
+     * @brief Color used by the cycle collector during trial deletion
+     *
+     */
+    enum class CycleColor : uint8_t
+    {
+        /**
+         * @brief In use or not visited by the collector
+         */
+        Black,
+        /**
+         * @brief Possible member of a garbage cycle, references from it were subtracted from the reference counts
+         */
+        Gray,
+        /**
+         * @brief Member of a garbage cycle
+         */
+        White,
+        /**
+         * @brief Possible root of a garbage cycle, stored in the root buffer of the machine
+         */
+        Purple,
+    };
+
     /**
      * @brief Class used to represent interpreter memory by using a linked list
      *
@@ -13,108 +51,231 @@ namespace GobLang
     class MemoryNode
     {
     public:
+        explicit MemoryNode(MemoryKind kind = MemoryKind::Object)
+            : m_kind(kind), m_dead(false), m_inZeroCountTable(false), m_marked(false), m_buffered(false), m_shared(false), m_interned(false) {}
+
+        MemoryKind getKind() const { return m_kind; }
+
         /**
-         * @brief Should be deleted by the garbage collector or not
+         * @brief Object was released by the garbage collector, but can't be deleted yet because the cycle collector still has a pointer to it
          *
          * @return true
          * @return false
          */
-        bool isDead() const { return m_dead || m_refCount <= 0; }
+        bool isDead() const { return m_dead; }
+
+        void setDead(bool dead) { m_dead = dead; }
         /**
          * @brief Get the next node in the list
          *
          * @return MemoryNode*
          */
         MemoryNode *getNext() { return m_next; }
+
         /**
-         * @brief Insert a new memory node after this one. Current child node will become child of the inserted node
+         * @brief Get the previous node in the list
          *
-         * @param node Node to insert
+         * @return MemoryNode*
          */
-        void insert(MemoryNode *node);
+        MemoryNode *getPrev() { return m_prev; }
+
+        void increaseRefCount();
+
+        void decreaseRefCount();
+
+        int32_t getRefCount() const { return m_refCount; }
 
         /**
-         * @brief Erase current m_next by replacing it with the child of that object. Does not call any memory freeing functions
+         * @brief Is the node stored in the zero count table of the machine
          *
          */
-        void eraseNext();
+        bool isInZeroCountTable() const { return m_inZeroCountTable; }
+
+        void setInZeroCountTable(bool inTable) { m_inZeroCountTable = inTable; }
 
         /**
-         * @brief Insert a node at the end of the chain
+         * @brief Is the node marked as reachable by the garbage collector
          *
-         * @param node Node to insert
          */
-        void pushBack(MemoryNode *node);
+        bool isMarked() const { return m_marked; }
 
-        void increaseRefCount();
+        void setMarked(bool marked) { m_marked = marked; }
 
-        void decreaseRefCount();
+        CycleColor getColor() const { return m_color; }
 
-        int32_t getRefCount() const { return m_refCount; }
+        void setColor(CycleColor color) { m_color = color; }
+
+        /**
+         * @brief Is the node stored in the cycle root buffer of the machine
+         *
+         */
+        bool isBuffered() const { return m_buffered; }
+
+        void setBuffered(bool buffered) { m_buffered = buffered; }
 
         /**
-         * @brief Size of the memory chain
+         * @brief Is the node stored in the string index of the machine, so `createString` can return it instead of a new string
          *
-         * @return size_t
          */
-        size_t length();
+        bool isInterned() const { return m_interned; }
+
+        void setInterned(bool interned) { m_interned = interned; }
 
         /**
-         * @brief Check if this memory value is equal to other value. This should be overriden to have type specific to avoid java situation
+         * @brief Check if this memory value is equal to other value. Strings are compared by contents, everything else by identity
          *
          * @param other
          * @return true
          * @return false
          */
-        virtual bool equalsTo(MemoryNode *other);
+        bool equalsTo(MemoryNode *other);
 
         virtual std::string toString() { return "Memory object"; }
 
         virtual ~MemoryNode() = default;
 
     private:
+        friend class MemoryList;
+        friend class StringNode;
         /**
          * @brief Next value in memory
          *
          */
         MemoryNode *m_next = nullptr;
         /**
-         * @brief Is marked for deletion by garbage collector?
+         * @brief Previous value in memory, lets the node be unlinked without walking the list
          *
          */
-        bool m_dead = false;
+        MemoryNode *m_prev = nullptr;
 
         int32_t m_refCount = 0;
+
+        MemoryKind m_kind;
+
+        CycleColor m_color = CycleColor::Black;
+        /**
+         * @brief Is marked for deletion by garbage collector?
+         *
+         */
+        bool m_dead : 1;
+
+        bool m_inZeroCountTable : 1;
+
+        bool m_marked : 1;
+
+        bool m_buffered : 1;
+        /**
+         * @brief Is the string reading characters owned by someone else. Kept in the header, so strings don't need a separate flag
+         *
+         */
+        bool m_shared : 1;
+
+        bool m_interned : 1;
+    };
+    // reference count, kind and flags share one word after the vtable and the list pointers
+    static_assert(sizeof(MemoryNode) <= 4 * sizeof(void *), "Memory object header should stay compact");
+
+    /**
+     * @brief Intrusive doubly linked list of all objects owned by the machine. Adding and removing objects takes constant time
+     *
+     */
+    class MemoryList
+    {
+    public:
+        /**
+         * @brief Add the node to the end of the list
+         *
+         * @param node Node that is not in any list
+         */
+        void pushBack(MemoryNode *node);
+
+        /**
+         * @brief Remove the node from the list. Does not call any memory freeing functions
+         *
+         * @param node Node that is in this list
+         */
+        void erase(MemoryNode *node);
+
+        /**
+         * @brief Forget all nodes without visiting them. Nodes are not unlinked from each other, so they must be deleted right after
+         *
+         */
+        void clear();
+
+        MemoryNode *getFirst() { return m_first; }
+
+        MemoryNode *getLast() { return m_last; }
+
+        size_t getSize() const { return m_size; }
+
+        bool empty() const { return m_size == 0; }
+
+    private:
+        MemoryNode *m_first = nullptr;
+        MemoryNode *m_last = nullptr;
+        size_t m_size = 0;
     };
 
+    /**
+     * @brief Cast memory object to the built in type using the kind of the object
+     *
+     * @tparam T Type with `Kind` constant, for example `StringNode` or `ArrayNode`
+     * @param node Object to cast, can be null
+     * @return T* Pointer to the object or nullptr if object has a different kind
+     */
+    template <class T>
+    T *memoryCast(MemoryNode *node)
+    {
+        return node != nullptr && node->getKind() == T::Kind ? static_cast<T *>(node) : nullptr;
+    }
+
     class StringNode : public MemoryNode
     {
     public:
-        explicit StringNode(std::string const &str) : m_str(str) {}
+        static constexpr MemoryKind Kind = MemoryKind::String;
+
+        explicit StringNode(std::string const &str);
+
+        /**
+         * @brief Construct a string that reads characters of a string owned by someone else, usually a string constant of the machine.
+         * Characters are copied on the first write, so the shared string is never modified
+         *
+         * @param shared String that must outlive the node
+         */
+        explicit StringNode(std::string const *shared);
 
-        std::string const &getString() { return m_str; }
+        std::string const &getString() const { return m_shared ? *m_sharedStr : m_str; }
 
         std::string toString() override { return getString(); }
 
         char getCharAt(size_t ind);
 
-        void setCharAt(char ch, size_t ind);
+        size_t getSize() const { return getString().size(); }
 
         /**
-         * @brief Compare other memory node and return true if both contain same sequence of characters
+         * @brief Check if characters are still read from the shared string instead of a copy owned by the node
          *
-         * @param other
-         * @return true
-         * @return false
          */
-        bool equalsTo(MemoryNode *other) override;
-
-        size_t getSize() const { return m_str.size(); }
+        bool isShared() const { return m_shared; }
 
-        virtual ~StringNode() = default;
+        virtual ~StringNode();
 
     private:
-        std::string m_str;
+        // writes go through the machine, which keeps its string index up to date
+        friend class Machine;
+
+        /**
+         * @brief Change a single character. Shared string is copied first
+         *
+         */
+        void setCharAt(char ch, size_t ind);
+
+        // only one of these is alive at a time, which one is decided by `m_shared`
+        union
+        {
+            std::string m_str;
+            std::string const *m_sharedStr;
+        };
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "MemoryPool.hpp"
+#include <new>
+#include <algorithm>
+#include <iterator>
+
+static_assert((GobLang::MemoryPool::MinBlockSize << 5) == GobLang::MemoryPool::MaxBlockSize, "Size classes must cover every small block");
+static_assert(MEMORY_POOL_CHUNK_SIZE % GobLang::MemoryPool::MaxBlockSize == 0, "Chunk must fit whole blocks");
+
+void *GobLang::MemoryPool::allocate(size_t size)
+{
+    if (size > MaxBlockSize)
+    {
+        return ::operator new(size);
+    }
+    size_t sizeClass = _getSizeClass(size);
+    if (FreeBlock *block = m_freeLists[sizeClass]; block != nullptr)
+    {
+        m_freeLists[sizeClass] = block->next;
+        return block;
+    }
+    size_t blockSize = MinBlockSize << sizeClass;
+    if (m_chunkTop == nullptr || (size_t)(m_chunkEnd - m_chunkTop) < blockSize)
+    {
+        // tail of the old chunk is too small for this class and stays unused, it is at most a single block of the biggest class
+        if (m_nextChunk == m_chunks.size())
+        {
+            m_chunks.push_back(static_cast<char *>(::operator new(MEMORY_POOL_CHUNK_SIZE)));
+        }
+        m_chunkTop = m_chunks[m_nextChunk++];
+        m_chunkEnd = m_chunkTop + MEMORY_POOL_CHUNK_SIZE;
+    }
+    void *block = m_chunkTop;
+    m_chunkTop += blockSize;
+    return block;
+}
+
+void GobLang::MemoryPool::free(void *ptr, size_t size)
+{
+    if (size > MaxBlockSize)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+    size_t sizeClass = _getSizeClass(size);
+    FreeBlock *block = static_cast<FreeBlock *>(ptr);
+    block->next = m_freeLists[sizeClass];
+    m_freeLists[sizeClass] = block;
+}
+
+void GobLang::MemoryPool::rewind()
+{
+    std::fill(std::begin(m_freeLists), std::end(m_freeLists), nullptr);
+    m_chunkTop = nullptr;
+    m_chunkEnd = nullptr;
+    m_nextChunk = 0;
+}
+
+GobLang::MemoryPool::~MemoryPool()
+{
+    for (char *chunk : m_chunks)
+    {
+        ::operator delete(chunk);
+    }
+}
+
+size_t GobLang::MemoryPool::_getSizeClass(size_t size)
+{
+    size_t sizeClass = 0;
+    while ((MinBlockSize << sizeClass) < size)
+    {
+        sizeClass++;
+    }
+    return sizeClass;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace GobLang
+{
+    /**
+     * @brief Allocator for objects owned by a single machine. Small blocks are rounded up to one of the size classes and are cut from large chunks,
+     * freed blocks go to the free list of their class and are reused by the next allocation of the same class.
+     * Blocks larger than the biggest class go straight to the system allocator.
+     * Pool is not shared between machines, so it needs no locking
+     *
+     */
+    class MemoryPool
+    {
+    public:
+        MemoryPool() = default;
+
+        MemoryPool(MemoryPool const &) = delete;
+
+        MemoryPool &operator=(MemoryPool const &) = delete;
+
+        /**
+         * @brief Allocate a block of memory aligned for any object that the machine stores
+         *
+         * @param size Size of the block in bytes
+         * @return void* Pointer to the block
+         */
+        void *allocate(size_t size);
+
+        /**
+         * @brief Return the block to the pool
+         *
+         * @param ptr Pointer returned by `allocate`
+         * @param size Same size that was passed to `allocate`
+         */
+        void free(void *ptr, size_t size);
+
+        /**
+         * @brief Make every block cut from chunks free at once without visiting them. Chunks are kept and reused by the following allocations.
+         * Blocks larger than `MaxBlockSize` don't live in chunks and must still be freed one by one
+         *
+         */
+        void rewind();
+
+        /**
+         * @brief Get amount of bytes taken from the system allocator for chunks
+         *
+         */
+        size_t getReservedSize() const { return m_chunks.size() * MEMORY_POOL_CHUNK_SIZE; }
+
+        ~MemoryPool();
+
+        /**
+         * @brief Smallest size class, every block is a multiple of it
+         *
+         */
+        static constexpr size_t MinBlockSize = 16;
+        /**
+         * @brief Biggest size class, larger blocks use the system allocator
+         *
+         */
+        static constexpr size_t MaxBlockSize = 512;
+
+    private:
+        static constexpr size_t SizeClassCount = 6;
+
+        /**
+         * @brief Free block is reused to store pointer to the next free block of the same class
+         *
+         */
+        struct FreeBlock
+        {
+            FreeBlock *next;
+        };
+
+        /**
+         * @brief Get index of the smallest size class that fits the block. Classes are powers of two starting from `MinBlockSize`
+         *
+         */
+        static size_t _getSizeClass(size_t size);
+
+        FreeBlock *m_freeLists[SizeClassCount] = {};
+        std::vector<char *> m_chunks;
+        /**
+         * @brief Unused part of the last chunk
+         *
+         */
+        char *m_chunkTop = nullptr;
+        char *m_chunkEnd = nullptr;
+        /**
+         * @brief Index of the chunk that is used once the current one is full, chunks after the current one are only left after `rewind`
+         *
+         */
+        size_t m_nextChunk = 0;
+    };
+}
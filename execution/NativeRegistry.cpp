@@ -0,0 +1,65 @@
+#include "NativeRegistry.hpp"
+#include "Memory.hpp"
+#include "Array.hpp"
+#include "Exception.hpp"
+
+GobLang::StringNode *GobLang::NativeArguments::getString(size_t id) const
+{
+    MemoryValue const &val = get(id);
+    if (val.getType() == Type::MemoryObj)
+    {
+        if (StringNode *node = memoryCast<StringNode>(val.getObject()); node != nullptr)
+        {
+            return node;
+        }
+    }
+    _failType(id, "String", val);
+}
+
+GobLang::ArrayNode *GobLang::NativeArguments::getArray(size_t id) const
+{
+    MemoryValue const &val = get(id);
+    if (val.getType() == Type::MemoryObj)
+    {
+        if (ArrayNode *node = memoryCast<ArrayNode>(val.getObject()); node != nullptr)
+        {
+            return node;
+        }
+    }
+    _failType(id, "Array", val);
+}
+
+void GobLang::NativeArguments::_failCount(size_t id) const
+{
+    throw RuntimeException(std::string("Argument ") + std::to_string(id) + " of function '" + m_functionName + "' is missing, got " +
+                           std::to_string(m_count) + " arguments");
+}
+
+void GobLang::NativeArguments::_failType(size_t id, const char *expected, MemoryValue const &val) const
+{
+    throw RuntimeException(std::string("Argument ") + std::to_string(id) + " of function '" + m_functionName + "' must be " +
+                           expected + ", got " + typeToString(val.getType()));
+}
+
+size_t GobLang::NativeRegistry::add(std::string const &name, NativeFunctionPointer func, void *userData)
+{
+    if (int64_t id = find(name); id != -1)
+    {
+        m_entries[id] = Entry{.name = name, .function = func, .userData = userData};
+        return id;
+    }
+    m_entries.push_back(Entry{.name = name, .function = func, .userData = userData});
+    return m_entries.size() - 1;
+}
+
+int64_t GobLang::NativeRegistry::find(std::string const &name) const
+{
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        if (m_entries[i].name == name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "Value.hpp"
+
+namespace GobLang
+{
+    class Machine;
+    class StringNode;
+    class ArrayNode;
+
+    /**
+     * @brief View of the arguments passed to a native function. Values stay on the operation stack, so reading them doesn't copy or allocate anything.
+     * Typed getters check the amount of arguments and the type and throw RuntimeException on mismatch.
+     * View stays valid until the function pushes its result, so all arguments must be read before that
+     *
+     */
+    class NativeArguments
+    {
+    public:
+        explicit NativeArguments(MemoryValue const *values, size_t count, const char *functionName)
+            : m_values(values), m_count(count), m_functionName(functionName) {}
+
+        size_t size() const { return m_count; }
+
+        bool empty() const { return m_count == 0; }
+
+        /**
+         * @brief Get the argument without checking if it exists
+         *
+         */
+        MemoryValue const &operator[](size_t id) const
+        {
+            assert(id < m_count);
+            return m_values[id];
+        }
+
+        /**
+         * @brief Get the argument of any type. Throws RuntimeException if function received fewer arguments
+         *
+         */
+        MemoryValue const &get(size_t id) const
+        {
+            if (id >= m_count)
+            {
+                _failCount(id);
+            }
+            return m_values[id];
+        }
+
+        int32_t getInt(size_t id) const { return _expect(id, Type::Int).getInt(); }
+
+        float getNumber(size_t id) const { return _expect(id, Type::Number).getNumber(); }
+
+        bool getBool(size_t id) const { return _expect(id, Type::Bool).getBool(); }
+
+        char getChar(size_t id) const { return _expect(id, Type::Char).getChar(); }
+
+        MemoryNode *getObject(size_t id) const { return _expect(id, Type::MemoryObj).getObject(); }
+
+        StringNode *getString(size_t id) const;
+
+        ArrayNode *getArray(size_t id) const;
+
+    private:
+        MemoryValue const &_expect(size_t id, Type type) const
+        {
+            MemoryValue const &val = get(id);
+            if (val.getType() != type)
+            {
+                _failType(id, typeToString(type), val);
+            }
+            return val;
+        }
+
+        [[noreturn]] void _failCount(size_t id) const;
+
+        [[noreturn]] void _failType(size_t id, const char *expected, MemoryValue const &val) const;
+
+        MemoryValue const *m_values;
+        size_t m_count;
+        const char *m_functionName;
+    };
+
+    /**
+     * @brief Native function that can be called from the code. Function may push a single value onto the operation stack,
+     * which becomes the result of the call. Arguments are removed from the stack by the machine once function returns
+     *
+     * @param machine Machine that called the function
+     * @param args Arguments of the call
+     * @param userData Pointer that was passed when function was registered
+     */
+    using NativeFunctionPointer = void (*)(Machine *machine, NativeArguments const &args, void *userData);
+
+    /**
+     * @brief Table of native functions. Compiler uses it to find out which names are native functions,
+     * so that calls to them are compiled into `CallNative` instead of looking the function up by name every time
+     *
+     */
+    class NativeRegistry
+    {
+    public:
+        struct Entry
+        {
+            std::string name;
+            NativeFunctionPointer function;
+            void *userData;
+        };
+
+        /**
+         * @brief Add a native function. Function with the same name is replaced
+         *
+         * @param name Name used by the code to call the function
+         * @param func Function to call
+         * @param userData Pointer that is passed to every call of the function
+         * @return size_t Id of the function
+         */
+        size_t add(std::string const &name, NativeFunctionPointer func, void *userData = nullptr);
+
+        /**
+         * @brief Find id of the function with the given name
+         *
+         * @return int64_t Id of the function or -1 if there is no function with this name
+         */
+        int64_t find(std::string const &name) const;
+
+        Entry const &get(size_t id) const { return m_entries[id]; }
+
+        size_t getCount() const { return m_entries.size(); }
+
+    private:
+        std::vector<Entry> m_entries;
+    };
+}
@@ -0,0 +1,29 @@
+#include "Nursery.hpp"
+#include <new>
+
+GobLang::StringNode *GobLang::Nursery::createString(std::string const *constant)
+{
+    if (m_top == m_capacity)
+    {
+        return nullptr;
+    }
+    if (m_slots.empty())
+    {
+        m_slots.resize(m_capacity);
+    }
+    return new (&m_slots[m_top++]) StringNode(constant);
+}
+
+void GobLang::Nursery::clear()
+{
+    for (size_t i = 0; i < m_top; i++)
+    {
+        reinterpret_cast<StringNode *>(&m_slots[i])->~StringNode();
+    }
+    m_top = 0;
+}
+
+GobLang::Nursery::~Nursery()
+{
+    clear();
+}
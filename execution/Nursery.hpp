@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <type_traits>
+#include "Memory.hpp"
+
+namespace GobLang
+{
+    /**
+     * @brief Bump allocator for short lived strings created from string constants.
+     * Strings are placed one after another in a single block and are all destroyed at once when the nursery is cleared,
+     * so most of them never go through the system allocator. Nursery strings are not owned by the memory list,
+     * the machine copies them to the heap once they are stored somewhere or when the nursery is cleared
+     *
+     */
+    class Nursery
+    {
+    public:
+        /**
+         * @brief Construct a new Nursery object. Storage is only allocated once the first string is created
+         *
+         * @param capacity Amount of strings that fit into the nursery
+         */
+        explicit Nursery(size_t capacity) : m_capacity(capacity) {}
+
+        Nursery(Nursery const &) = delete;
+
+        Nursery &operator=(Nursery const &) = delete;
+
+        /**
+         * @brief Create a new string in the nursery that shares characters of the constant until it is written to
+         *
+         * @param constant String constant that outlives the nursery
+         * @return StringNode* New string or nullptr if the nursery is full
+         */
+        StringNode *createString(std::string const *constant);
+
+        /**
+         * @brief Check if the object was created by this nursery. Only compares the address, so it doesn't touch the object itself
+         *
+         */
+        bool contains(MemoryNode const *node) const
+        {
+            return node >= _begin() && node < _begin() + m_top;
+        }
+
+        /**
+         * @brief Get index of the string in the nursery, strings are numbered in the order they were created
+         *
+         */
+        size_t getIndex(MemoryNode const *node) const { return static_cast<StringNode const *>(node) - _begin(); }
+
+        /**
+         * @brief Destroy every string in the nursery, pointers to them become invalid
+         *
+         */
+        void clear();
+
+        bool isFull() const { return m_top == m_capacity; }
+
+        bool empty() const { return m_top == 0; }
+
+        size_t getSize() const { return m_top; }
+
+        ~Nursery();
+
+    private:
+        using Slot = std::aligned_storage_t<sizeof(StringNode), alignof(StringNode)>;
+
+        StringNode const *_begin() const { return reinterpret_cast<StringNode const *>(m_slots.data()); }
+
+        std::vector<Slot> m_slots;
+        size_t m_capacity;
+        /**
+         * @brief Index of the next free slot
+         *
+         */
+        size_t m_top = 0;
+    };
+}
@@ -4,11 +4,15 @@
 #include <cstdint>
 namespace GobLang
 {
-    enum class Operation
+    enum class Operation : uint8_t
     {
         None,
         Add,
         Sub,
+        /**
+         * @brief Call function on top of the stack. Uses 1 byte for the argument count.
+         * Arguments are removed from the stack after the call and exactly one value(null if function returned nothing) is pushed
+         */
         Call,
         Set,
         Get,
@@ -49,24 +53,170 @@ namespace GobLang
          * @brief Shrink local variable array by n variables
          */
         ShrinkLocal,
+        /**
+         * @brief Fused `GetLocal x, PushConstInt k, Add, SetLocal x`. Uses 1 byte for local id and 1 byte for int constant id
+         */
+        IncLocalByConst,
+        /**
+         * @brief Fused `GetLocal x, PushConstInt k, Sub, SetLocal x`. Uses 1 byte for local id and 1 byte for int constant id
+         */
+        DecLocalByConst,
+        /**
+         * @brief Fused `GetLocal a, GetLocal b, Less, JumpIfNot`. Uses 2 bytes for local ids followed by sizeof(size_t) bytes for the address
+         */
+        JumpIfLocalNotLessLocal,
+        /**
+         * @brief Fused `GetLocal a, PushConstInt k, Less, JumpIfNot`. Uses 1 byte for local id, 1 byte for int constant id followed by sizeof(size_t) bytes for the address
+         */
+        JumpIfLocalNotLessConst,
+        /**
+         * @brief Fused `GetLocal index, GetLocal array, GetArray`. Uses 1 byte for array local id and 1 byte for index local id
+         */
+        GetLocalArrayItem,
+        /**
+         * @brief Fused `PushConstString name, Get`. Reads global variable using name from string constants without creating a string object
+         */
+        GetGlobalConst,
+        /**
+         * @brief Remove value from the top of the stack. Used for expressions whose result is never used
+         */
+        Pop,
+        /**
+         * @brief Call native function directly without looking it up by name. Uses 1 byte for the id of the function in the native function table
+         * of the byte code and 1 byte for the argument count. Same as `Call` otherwise
+         */
+        CallNative,
+        /**
+         * @brief Copy value between registers. Uses 1 byte for destination and 1 byte for source register
+         *
+         * All register operations address registers using 1 byte ids. Registers with ids lower than amount of local variables are local variables,
+         * everything after that is temporary values. Destination register always goes first
+         */
+        RegMove,
+        /**
+         * @brief Load int constant into register. Uses 1 byte for register and 1 byte for int constant id
+         */
+        RegLoadInt,
+        /**
+         * @brief Load char into register. Uses 1 byte for register and 1 byte for the char
+         */
+        RegLoadChar,
+        /**
+         * @brief Load bool into register. Uses 1 byte for register and 1 byte for the value
+         */
+        RegLoadBool,
+        /**
+         * @brief Create new string from string constant and load it into register. Uses 1 byte for register and 1 byte for string constant id
+         */
+        RegLoadString,
+        /**
+         * @brief Load value of the global variable into register. Uses 1 byte for register and 1 byte for string constant id of the name
+         */
+        RegGetGlobal,
+        /**
+         * @brief Set value of the global variable. Uses 1 byte for string constant id of the name and 1 byte for the register
+         */
+        RegSetGlobal,
+        RegAdd,
+        RegSub,
+        RegEquals,
+        RegNotEq,
+        RegLess,
+        RegMore,
+        RegLessOrEq,
+        RegMoreOrEq,
+        RegAnd,
+        RegOr,
+        RegNot,
+        RegNegate,
+        /**
+         * @brief Get item of an array. Uses 1 byte for destination, 1 byte for array and 1 byte for index register
+         */
+        RegGetArray,
+        /**
+         * @brief Set item of an array. Uses 1 byte for array, 1 byte for index and 1 byte for value register
+         */
+        RegSetArray,
+        /**
+         * @brief Call a function. Uses 1 byte for destination, 1 byte for function, 1 byte for first argument register and 1 byte for argument count.
+         * Arguments must be stored in consecutive registers
+         */
+        RegCall,
+        /**
+         * @brief Call native function directly. Uses 1 byte for destination, 1 byte for the id in the native function table of the byte code,
+         * 1 byte for first argument register and 1 byte for argument count
+         */
+        RegCallNative,
+        /**
+         * @brief Jump if register contains false. Uses 1 byte for the register followed by sizeof(size_t) bytes for the address
+         */
+        RegJumpIfNot,
+        /**
+         * @brief `Add` specialized for two integers. Quickened operations are never emitted by the compiler,
+         * interpreter replaces generic operations with them once it sees operand types and switches back if types change
+         */
+        AddIntInt,
+        /**
+         * @brief `Less` specialized for two integers
+         */
+        LessIntInt,
+        /**
+         * @brief `Equals` specialized for two characters
+         */
+        EqChar,
+        /**
+         * @brief `GetArray` specialized for an array indexed by an integer
+         */
+        GetArrayIndexInt,
         /**
          * @brief End program execution
          */
         End
     };
 
+    /**
+     * @brief Operation decoded from the byte code into a fixed width record. Operand bytes, resolved constants and
+     * jump targets are read once at load time so the interpreter loop doesn't need to decode anything
+     *
+     */
+    struct Instruction
+    {
+        Operation op = Operation::None;
+        /**
+         * @brief First three argument bytes of the operation, unused ones are 0
+         *
+         */
+        uint8_t a = 0;
+        uint8_t b = 0;
+        uint8_t c = 0;
+        /**
+         * @brief Constant value used by the operation, already resolved from the constant table
+         *
+         */
+        int32_t value = 0;
+        /**
+         * @brief Index of the instruction that jump operations go to
+         *
+         */
+        uint32_t target = 0;
+    };
+
     struct OperationData
     {
         Operation op;
         const char *text;
         int32_t argCount;
+        /**
+         * @brief If true last sizeof(size_t) bytes of the arguments are the jump address
+         */
+        bool isJump = false;
     };
 
     static const std::vector<OperationData> Operations = {
         OperationData{.op = Operation::None, .text = "noop", .argCount = 0},
         OperationData{.op = Operation::Add, .text = "add", .argCount = 0},
         OperationData{.op = Operation::Sub, .text = "sub", .argCount = 0},
-        OperationData{.op = Operation::Call, .text = "call", .argCount = 0},
+        OperationData{.op = Operation::Call, .text = "call", .argCount = 1},
         OperationData{.op = Operation::Set, .text = "set_global", .argCount = 0},
         OperationData{.op = Operation::Get, .text = "get_global", .argCount = 0},
         OperationData{.op = Operation::SetLocal, .text = "set", .argCount = 1},
@@ -80,15 +230,152 @@ namespace GobLang
         OperationData{.op = Operation::PushFalse, .text = "push_false", .argCount = 0},
         OperationData{.op = Operation::Equals, .text = "eq", .argCount = 0},
         OperationData{.op = Operation::NotEq, .text = "neq", .argCount = 0},
+        OperationData{.op = Operation::And, .text = "and", .argCount = 0},
+        OperationData{.op = Operation::Or, .text = "or", .argCount = 0},
         OperationData{.op = Operation::Not, .text = "not", .argCount = 0},
         OperationData{.op = Operation::Negate, .text = "negate", .argCount = 0},
         OperationData{.op = Operation::More, .text = "more", .argCount = 0},
         OperationData{.op = Operation::Less, .text = "less", .argCount = 0},
         OperationData{.op = Operation::MoreOrEq, .text = "eqmore", .argCount = 0},
         OperationData{.op = Operation::LessOrEq, .text = "eqless", .argCount = 0},
-        OperationData{.op = Operation::Jump, .text = "goto", .argCount = sizeof(size_t)},
-        OperationData{.op = Operation::JumpIfNot, .text = "goto_if_not", .argCount = sizeof(size_t)},
+        OperationData{.op = Operation::Jump, .text = "goto", .argCount = sizeof(size_t), .isJump = true},
+        OperationData{.op = Operation::JumpIfNot, .text = "goto_if_not", .argCount = sizeof(size_t), .isJump = true},
         OperationData{.op = Operation::ShrinkLocal, .text = "local_free", .argCount = 1},
+        OperationData{.op = Operation::IncLocalByConst, .text = "inc", .argCount = 2},
+        OperationData{.op = Operation::DecLocalByConst, .text = "dec", .argCount = 2},
+        OperationData{.op = Operation::JumpIfLocalNotLessLocal, .text = "goto_if_not_less", .argCount = 2 + sizeof(size_t), .isJump = true},
+        OperationData{.op = Operation::JumpIfLocalNotLessConst, .text = "goto_if_not_less_int", .argCount = 2 + sizeof(size_t), .isJump = true},
+        OperationData{.op = Operation::GetLocalArrayItem, .text = "get_arr_local", .argCount = 2},
+        OperationData{.op = Operation::GetGlobalConst, .text = "get_global_const", .argCount = 1},
+        OperationData{.op = Operation::Pop, .text = "pop", .argCount = 0},
+        OperationData{.op = Operation::CallNative, .text = "call_native", .argCount = 2},
+        OperationData{.op = Operation::RegMove, .text = "reg_mov", .argCount = 2},
+        OperationData{.op = Operation::RegLoadInt, .text = "reg_load_int", .argCount = 2},
+        OperationData{.op = Operation::RegLoadChar, .text = "reg_load_char", .argCount = 2},
+        OperationData{.op = Operation::RegLoadBool, .text = "reg_load_bool", .argCount = 2},
+        OperationData{.op = Operation::RegLoadString, .text = "reg_load_str", .argCount = 2},
+        OperationData{.op = Operation::RegGetGlobal, .text = "reg_get_global", .argCount = 2},
+        OperationData{.op = Operation::RegSetGlobal, .text = "reg_set_global", .argCount = 2},
+        OperationData{.op = Operation::RegAdd, .text = "reg_add", .argCount = 3},
+        OperationData{.op = Operation::RegSub, .text = "reg_sub", .argCount = 3},
+        OperationData{.op = Operation::RegEquals, .text = "reg_eq", .argCount = 3},
+        OperationData{.op = Operation::RegNotEq, .text = "reg_neq", .argCount = 3},
+        OperationData{.op = Operation::RegLess, .text = "reg_less", .argCount = 3},
+        OperationData{.op = Operation::RegMore, .text = "reg_more", .argCount = 3},
+        OperationData{.op = Operation::RegLessOrEq, .text = "reg_eqless", .argCount = 3},
+        OperationData{.op = Operation::RegMoreOrEq, .text = "reg_eqmore", .argCount = 3},
+        OperationData{.op = Operation::RegAnd, .text = "reg_and", .argCount = 3},
+        OperationData{.op = Operation::RegOr, .text = "reg_or", .argCount = 3},
+        OperationData{.op = Operation::RegNot, .text = "reg_not", .argCount = 2},
+        OperationData{.op = Operation::RegNegate, .text = "reg_negate", .argCount = 2},
+        OperationData{.op = Operation::RegGetArray, .text = "reg_get_arr", .argCount = 3},
+        OperationData{.op = Operation::RegSetArray, .text = "reg_set_arr", .argCount = 3},
+        OperationData{.op = Operation::RegCall, .text = "reg_call", .argCount = 4},
+        OperationData{.op = Operation::RegCallNative, .text = "reg_call_native", .argCount = 4},
+        OperationData{.op = Operation::RegJumpIfNot, .text = "reg_goto_if_not", .argCount = 1 + sizeof(size_t), .isJump = true},
+        OperationData{.op = Operation::AddIntInt, .text = "add_int", .argCount = 0},
+        OperationData{.op = Operation::LessIntInt, .text = "less_int", .argCount = 0},
+        OperationData{.op = Operation::EqChar, .text = "eq_char", .argCount = 0},
+        OperationData{.op = Operation::GetArrayIndexInt, .text = "get_arr_int", .argCount = 0},
         OperationData{.op = Operation::End, .text = "hlt", .argCount = 0},
     };
+
+    /**
+     * @brief Find description of the given operation
+     *
+     * @param op Operation to look for
+     * @return OperationData const* Description of the operation or nullptr if operation is unknown
+     */
+    inline OperationData const *getOperationData(Operation op)
+    {
+        for (std::vector<OperationData>::const_iterator it = Operations.begin(); it != Operations.end(); it++)
+        {
+            if (it->op == op)
+            {
+                return &(*it);
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Check if operation works on registers instead of the operation stack
+     *
+     */
+    inline bool isRegisterOperation(Operation op)
+    {
+        return op >= Operation::RegMove && op <= Operation::RegJumpIfNot;
+    }
+
+    /**
+     * @brief Get how many values operation takes from the operation stack and how many it puts on it.
+     * Register operations don't use the stack, except for `RegCall` and `RegCallNative` which only use it while the function is running
+     *
+     * @param instr Instruction to check
+     * @param pop Amount of values taken from the stack
+     * @param push Amount of values put on the stack
+     */
+    inline void getStackEffect(Instruction const &instr, int32_t &pop, int32_t &push)
+    {
+        pop = 0;
+        push = 0;
+        switch (instr.op)
+        {
+        case Operation::Add:
+        case Operation::Sub:
+        case Operation::Equals:
+        case Operation::NotEq:
+        case Operation::Less:
+        case Operation::More:
+        case Operation::LessOrEq:
+        case Operation::MoreOrEq:
+        case Operation::And:
+        case Operation::Or:
+        case Operation::GetArray:
+        case Operation::AddIntInt:
+        case Operation::LessIntInt:
+        case Operation::EqChar:
+        case Operation::GetArrayIndexInt:
+            pop = 2;
+            push = 1;
+            break;
+        case Operation::Not:
+        case Operation::Negate:
+        case Operation::Get:
+            pop = 1;
+            push = 1;
+            break;
+        case Operation::Call:
+            pop = 1 + instr.a;
+            push = 1;
+            break;
+        case Operation::CallNative:
+            pop = instr.b;
+            push = 1;
+            break;
+        case Operation::Set:
+            pop = 2;
+            break;
+        case Operation::SetArray:
+            pop = 3;
+            break;
+        case Operation::SetLocal:
+        case Operation::JumpIfNot:
+        case Operation::Pop:
+            pop = 1;
+            break;
+        case Operation::GetLocal:
+        case Operation::PushConstInt:
+        case Operation::PushConstChar:
+        case Operation::PushConstString:
+        case Operation::PushTrue:
+        case Operation::PushFalse:
+        case Operation::GetLocalArrayItem:
+        case Operation::GetGlobalConst:
+            push = 1;
+            break;
+        default:
+            break;
+        }
+    }
 } // namespace SimpleLang
@@ -1,9 +1,10 @@
 #pragma once
+#include <cstdint>
 
 namespace GobLang
 {
 
-    enum class Type
+    enum class Type : uint8_t
     {
         Null,
         Char,
@@ -3,51 +3,50 @@
 #include <iostream>
 bool GobLang::areEqual(MemoryValue const &a, MemoryValue const &b)
 {
-    if (a.type != b.type)
+    if (a.getType() != b.getType())
     {
         return false;
     }
-    switch (a.type)
+    switch (a.getType())
     {
     case Type::Null:
         return true;
     case Type::Bool:
-        return std::get<bool>(a.value) == std::get<bool>(b.value);
+        return a.getBool() == b.getBool();
     case Type::Number:
-        return std::get<float>(a.value) == std::get<float>(b.value);
+        return a.getNumber() == b.getNumber();
     case Type::Int:
-        return std::get<int32_t>(a.value) == std::get<int32_t>(b.value);
+        return a.getInt() == b.getInt();
     case Type::Char:
-        return std::get<char>(a.value) == std::get<char>(b.value);
+        return a.getChar() == b.getChar();
     case Type::UserData:
-        return std::get<void *>(a.value) == std::get<void *>(b.value);
+        return a.getUserData() == b.getUserData();
     case Type::MemoryObj:
-        return std::get<MemoryNode *>(a.value)->equalsTo(std::get<MemoryNode *>(b.value));
+        return a.getObject()->equalsTo(b.getObject());
     case Type::NativeFunction:
-        // c++ has no equality check for std::function
-        return false;
+        return a.getNativeFunction() == b.getNativeFunction();
     }
     return false;
 }
 
 std::string GobLang::valueToString(MemoryValue const &val)
 {
-    switch (val.type)
+    switch (val.getType())
     {
     case Type::Null:
         return "null";
     case Type::Bool:
-        return std::get<bool>(val.value) ? "true" : "false";
+        return val.getBool() ? "true" : "false";
     case Type::Number:
-        return std::to_string(std::get<float>(val.value));
+        return std::to_string(val.getNumber());
     case Type::Int:
-        return std::to_string(std::get<int32_t>(val.value));
+        return std::to_string(val.getInt());
     case Type::UserData:
-        return std::to_string((const size_t)std::get<void *>(val.value));
+        return std::to_string((const size_t)val.getUserData());
     case Type::MemoryObj:
-        return std::get<MemoryNode *>(val.value)->toString();
+        return val.getObject()->toString();
     case Type::Char:
-        return std::string{std::get<char>(val.value)};
+        return std::string{val.getChar()};
     case Type::NativeFunction:
         // c++ has no equality check for std::function
         return "Native function";
@@ -2,23 +2,210 @@
 #include <vector>
 #include <cstdint>
 #include <functional>
-#include <variant>
 #include <string>
+#include <type_traits>
+#include <cstring>
+#include <cassert>
 #include "Type.hpp"
 
 namespace GobLang
 {
     class Machine;
     class MemoryNode;
-    using FunctionValue = std::function<void(Machine *)>;
-    using Value = std::variant<bool, char, float, int32_t, void *, MemoryNode *, FunctionValue>;
+    class NativeArguments;
+    using FunctionValue = std::function<void(Machine *, NativeArguments const &)>;
 
-    struct MemoryValue
+    /**
+     * @brief Single value stored by the machine. Contents are only accessible through the `make*` and `get*` functions,
+     * so the layout can be switched with the `GOB_NAN_BOXING` build option without touching the code using it.
+     * Getters don't check the type, caller must check `getType()` first
+     *
+     */
+    class MemoryValue
     {
-        Type type;
-        Value value;
+    public:
+        MemoryValue() = default;
+
+        static MemoryValue makeNull() { return MemoryValue(); }
+        static MemoryValue makeBool(bool val);
+        static MemoryValue makeChar(char val);
+        static MemoryValue makeNumber(float val);
+        static MemoryValue makeInt(int32_t val);
+        static MemoryValue makeUserData(void *val);
+        static MemoryValue makeObject(MemoryNode *val);
+        /**
+         * @brief Create a value referencing native function
+         *
+         * @param id Index of the function in the function table of the machine
+         */
+        static MemoryValue makeNativeFunction(size_t id);
+
+        Type getType() const;
+        bool getBool() const;
+        char getChar() const;
+        float getNumber() const;
+        int32_t getInt() const;
+        void *getUserData() const;
+        MemoryNode *getObject() const;
+        size_t getNativeFunction() const;
+
+    private:
+#ifdef GOB_NAN_BOXING
+        /**
+         * @brief Every value that is not a number is stored as a negative quiet NaN with the type in bits 48-50
+         * and the payload in the lower 48 bits. Numbers are stored as plain doubles, NaNs produced by arithmetic
+         * are replaced with the positive canonical NaN so that they never look like a boxed value
+         *
+         */
+        static constexpr uint64_t BoxedBase = 0xFFF8000000000000ull;
+        static constexpr uint64_t CanonicalNaN = 0x7FF8000000000000ull;
+        static constexpr int TypeShift = 48;
+        static constexpr uint64_t PayloadMask = (1ull << TypeShift) - 1;
+
+        static MemoryValue _box(Type type, uint64_t payload);
+
+        uint64_t m_bits = BoxedBase;
+#else
+        /**
+         * @brief Payload of the memory value. Which field is valid is decided by the type stored next to it
+         *
+         */
+        union Value
+        {
+            bool boolean;
+            char character;
+            float number;
+            int32_t integer;
+            void *userData;
+            MemoryNode *object;
+            size_t function;
+        };
+
+        static MemoryValue _make(Type type);
+
+        Type m_type = Type::Null;
+        Value m_value = {};
+#endif
     };
 
+    static_assert(std::is_trivially_copyable_v<MemoryValue>, "Memory values are copied as plain bytes");
+#ifdef GOB_NAN_BOXING
+    static_assert(sizeof(MemoryValue) == 8, "NaN boxed memory value must fit into one word");
+#else
+    static_assert(sizeof(MemoryValue) == 16, "Memory value must be a tag and an 8 byte payload");
+#endif
+
+#ifdef GOB_NAN_BOXING
+    inline MemoryValue MemoryValue::_box(Type type, uint64_t payload)
+    {
+        MemoryValue val;
+        val.m_bits = BoxedBase | ((uint64_t)type << TypeShift) | payload;
+        return val;
+    }
+
+    inline MemoryValue MemoryValue::makeBool(bool val) { return _box(Type::Bool, val ? 1 : 0); }
+    inline MemoryValue MemoryValue::makeChar(char val) { return _box(Type::Char, (uint8_t)val); }
+    inline MemoryValue MemoryValue::makeNumber(float val)
+    {
+        MemoryValue res;
+        double d = val;
+        std::memcpy(&res.m_bits, &d, sizeof(d));
+        if (d != d)
+        {
+            res.m_bits = CanonicalNaN;
+        }
+        return res;
+    }
+    inline MemoryValue MemoryValue::makeInt(int32_t val) { return _box(Type::Int, (uint32_t)val); }
+    inline MemoryValue MemoryValue::makeUserData(void *val)
+    {
+        assert(((uintptr_t)val & ~PayloadMask) == 0);
+        return _box(Type::UserData, (uintptr_t)val);
+    }
+    inline MemoryValue MemoryValue::makeObject(MemoryNode *val)
+    {
+        assert(((uintptr_t)val & ~PayloadMask) == 0);
+        return _box(Type::MemoryObj, (uintptr_t)val);
+    }
+    inline MemoryValue MemoryValue::makeNativeFunction(size_t id) { return _box(Type::NativeFunction, id); }
+
+    inline Type MemoryValue::getType() const
+    {
+        return m_bits < BoxedBase ? Type::Number : (Type)((m_bits >> TypeShift) & 0x7);
+    }
+    inline bool MemoryValue::getBool() const { return (m_bits & PayloadMask) != 0; }
+    inline char MemoryValue::getChar() const { return (char)(uint8_t)m_bits; }
+    inline float MemoryValue::getNumber() const
+    {
+        double d;
+        std::memcpy(&d, &m_bits, sizeof(d));
+        return (float)d;
+    }
+    inline int32_t MemoryValue::getInt() const { return (int32_t)(uint32_t)m_bits; }
+    inline void *MemoryValue::getUserData() const { return (void *)(uintptr_t)(m_bits & PayloadMask); }
+    inline MemoryNode *MemoryValue::getObject() const { return (MemoryNode *)(uintptr_t)(m_bits & PayloadMask); }
+    inline size_t MemoryValue::getNativeFunction() const { return m_bits & PayloadMask; }
+#else
+    inline MemoryValue MemoryValue::_make(Type type)
+    {
+        MemoryValue val;
+        val.m_type = type;
+        return val;
+    }
+
+    inline MemoryValue MemoryValue::makeBool(bool val)
+    {
+        MemoryValue res = _make(Type::Bool);
+        res.m_value.boolean = val;
+        return res;
+    }
+    inline MemoryValue MemoryValue::makeChar(char val)
+    {
+        MemoryValue res = _make(Type::Char);
+        res.m_value.character = val;
+        return res;
+    }
+    inline MemoryValue MemoryValue::makeNumber(float val)
+    {
+        MemoryValue res = _make(Type::Number);
+        res.m_value.number = val;
+        return res;
+    }
+    inline MemoryValue MemoryValue::makeInt(int32_t val)
+    {
+        MemoryValue res = _make(Type::Int);
+        res.m_value.integer = val;
+        return res;
+    }
+    inline MemoryValue MemoryValue::makeUserData(void *val)
+    {
+        MemoryValue res = _make(Type::UserData);
+        res.m_value.userData = val;
+        return res;
+    }
+    inline MemoryValue MemoryValue::makeObject(MemoryNode *val)
+    {
+        MemoryValue res = _make(Type::MemoryObj);
+        res.m_value.object = val;
+        return res;
+    }
+    inline MemoryValue MemoryValue::makeNativeFunction(size_t id)
+    {
+        MemoryValue res = _make(Type::NativeFunction);
+        res.m_value.function = id;
+        return res;
+    }
+
+    inline Type MemoryValue::getType() const { return m_type; }
+    inline bool MemoryValue::getBool() const { return m_value.boolean; }
+    inline char MemoryValue::getChar() const { return m_value.character; }
+    inline float MemoryValue::getNumber() const { return m_value.number; }
+    inline int32_t MemoryValue::getInt() const { return m_value.integer; }
+    inline void *MemoryValue::getUserData() const { return m_value.userData; }
+    inline MemoryNode *MemoryValue::getObject() const { return m_value.object; }
+    inline size_t MemoryValue::getNativeFunction() const { return m_value.function; }
+#endif
+
     /**
      * @brief Compare two memory values and validate that both are equal
      *
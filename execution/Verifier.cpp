@@ -0,0 +1,181 @@
+#include "Verifier.hpp"
+#include "Exception.hpp"
+#include <algorithm>
+
+GobLang::Verifier::Verifier(std::vector<Instruction> const &instructions, size_t stringConstCount, size_t nativeCount)
+    : m_instructions(instructions), m_stringConstCount(stringConstCount), m_nativeCount(nativeCount)
+{
+}
+
+void GobLang::Verifier::verify()
+{
+    std::vector<int64_t> &depths = m_depths;
+    depths.assign(m_instructions.size(), -1);
+    std::vector<size_t> pending;
+    if (!m_instructions.empty())
+    {
+        depths[0] = 0;
+        pending.push_back(0);
+    }
+    while (!pending.empty())
+    {
+        size_t at = pending.back();
+        pending.pop_back();
+        // follow straight line code until the end of the basic block
+        while (true)
+        {
+            Instruction const &instr = m_instructions[at];
+            int64_t depth = depths[at];
+            int32_t pop, push;
+            getStackEffect(instr, pop, push);
+            if (depth < pop)
+            {
+                _fail(at, "operation needs " + std::to_string(pop) + " values, but stack only has " + std::to_string(depth));
+            }
+            int64_t peak = depth;
+            switch (instr.op)
+            {
+            case Operation::JumpIfLocalNotLessLocal:
+            case Operation::GetLocalArrayItem:
+                _useLocal(instr.b);
+                [[fallthrough]];
+            case Operation::GetLocal:
+            case Operation::SetLocal:
+            case Operation::IncLocalByConst:
+            case Operation::DecLocalByConst:
+            case Operation::JumpIfLocalNotLessConst:
+            case Operation::RegLoadInt:
+            case Operation::RegLoadChar:
+            case Operation::RegLoadBool:
+            case Operation::RegJumpIfNot:
+                _useLocal(instr.a);
+                break;
+            case Operation::RegMove:
+            case Operation::RegNot:
+            case Operation::RegNegate:
+                _useLocal(instr.a);
+                _useLocal(instr.b);
+                break;
+            case Operation::RegAdd:
+            case Operation::RegSub:
+            case Operation::RegEquals:
+            case Operation::RegNotEq:
+            case Operation::RegLess:
+            case Operation::RegMore:
+            case Operation::RegLessOrEq:
+            case Operation::RegMoreOrEq:
+            case Operation::RegAnd:
+            case Operation::RegOr:
+            case Operation::RegGetArray:
+            case Operation::RegSetArray:
+                _useLocal(instr.a);
+                _useLocal(instr.b);
+                _useLocal(instr.c);
+                break;
+            case Operation::RegCall:
+            case Operation::RegCallNative:
+                _useLocal(instr.a);
+                if (instr.op == Operation::RegCall)
+                {
+                    _useLocal(instr.b);
+                }
+                else
+                {
+                    _checkNative(at, instr.b);
+                }
+                if (instr.value > 0)
+                {
+                    _useLocal(instr.c + instr.value - 1);
+                }
+                // arguments are moved onto the stack for the duration of the call
+                peak = depth + instr.value;
+                break;
+            case Operation::CallNative:
+                _checkNative(at, instr.a);
+                break;
+            case Operation::PushConstString:
+            case Operation::GetGlobalConst:
+                _checkStringConst(at, instr.a);
+                break;
+            case Operation::RegLoadString:
+            case Operation::RegGetGlobal:
+                _useLocal(instr.a);
+                _checkStringConst(at, instr.b);
+                break;
+            case Operation::RegSetGlobal:
+                _useLocal(instr.b);
+                _checkStringConst(at, instr.a);
+                break;
+            default:
+                break;
+            }
+            depth = depth - pop + push;
+            m_maxStackDepth = std::max(m_maxStackDepth, (size_t)std::max(peak, depth));
+
+            std::vector<size_t> successors;
+            if (getOperationData(instr.op)->isJump)
+            {
+                successors.push_back(instr.target);
+            }
+            if (instr.op != Operation::Jump && instr.op != Operation::End)
+            {
+                successors.push_back(at + 1);
+            }
+            size_t next = m_instructions.size();
+            for (size_t succ : successors)
+            {
+                if (succ >= m_instructions.size())
+                {
+                    _fail(at, "execution continues past the last instruction");
+                }
+                if (depths[succ] == -1)
+                {
+                    depths[succ] = depth;
+                    if (succ == at + 1)
+                    {
+                        next = succ;
+                    }
+                    else
+                    {
+                        pending.push_back(succ);
+                    }
+                }
+                else if (depths[succ] != depth)
+                {
+                    _fail(succ, "reached with stack depth " + std::to_string(depth) + " and " + std::to_string(depths[succ]));
+                }
+            }
+            if (next == m_instructions.size())
+            {
+                break;
+            }
+            at = next;
+        }
+    }
+}
+
+void GobLang::Verifier::_useLocal(size_t id)
+{
+    m_localCount = std::max(m_localCount, id + 1);
+}
+
+void GobLang::Verifier::_checkStringConst(size_t at, size_t id)
+{
+    if (id >= m_stringConstCount)
+    {
+        _fail(at, "string constant " + std::to_string(id) + " doesn't exist");
+    }
+}
+
+void GobLang::Verifier::_checkNative(size_t at, size_t id)
+{
+    if (id >= m_nativeCount)
+    {
+        _fail(at, "native function " + std::to_string(id) + " doesn't exist");
+    }
+}
+
+void GobLang::Verifier::_fail(size_t at, std::string const &msg)
+{
+    throw RuntimeException("Byte code verification failed at instruction " + std::to_string(at) + ": " + msg);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "Operations.hpp"
+
+namespace GobLang
+{
+    /**
+     * @brief Load time check of decoded instructions. Proves that every instruction is reached with the same operation stack depth
+     * no matter which path leads to it, that the stack never underflows and that all constants exist.
+     * Programs that pass verification can be executed without any stack or local variable checks
+     *
+     */
+    class Verifier
+    {
+    public:
+        /**
+         * @brief Construct a new Verifier object
+         *
+         * @param instructions Decoded instructions, must end with `End` and all jump targets must be valid instruction indices
+         * @param stringConstCount Amount of string constants available to the program
+         * @param nativeCount Amount of entries in the native function table of the byte code
+         */
+        explicit Verifier(std::vector<Instruction> const &instructions, size_t stringConstCount, size_t nativeCount = 0);
+
+        /**
+         * @brief Check the instructions. Throws RuntimeException describing the first problem found
+         *
+         */
+        void verify();
+
+        /**
+         * @brief Get the largest amount of values that can be on the operation stack at the same time
+         *
+         */
+        size_t getMaxStackDepth() const { return m_maxStackDepth; }
+
+        /**
+         * @brief Get amount of local variables or registers that are addressed by the program
+         *
+         */
+        size_t getLocalCount() const { return m_localCount; }
+
+        /**
+         * @brief Get depth of the operation stack before the instruction is executed
+         *
+         * @param at Index of the instruction
+         * @return int64_t Depth of the stack or -1 if instruction can never be reached
+         */
+        int64_t getStackDepth(size_t at) const { return m_depths[at]; }
+
+    private:
+        void _useLocal(size_t id);
+
+        void _checkStringConst(size_t at, size_t id);
+
+        void _checkNative(size_t at, size_t id);
+
+        [[noreturn]] void _fail(size_t at, std::string const &msg);
+
+        std::vector<Instruction> const &m_instructions;
+        size_t m_stringConstCount;
+        size_t m_nativeCount;
+        size_t m_maxStackDepth = 0;
+        size_t m_localCount = 0;
+        /**
+         * @brief Depth of the operation stack before each instruction, -1 means that instruction wasn't reached
+         *
+         */
+        std::vector<int64_t> m_depths;
+    };
+}
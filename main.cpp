@@ -33,8 +33,14 @@ void byteCodeToText(std::vector<uint8_t> const &bytecode)
         if (opIt != GobLang::Operations.end())
         {
             std::cout << std::hex << address << std::dec << ": " << (opIt->text) << " ";
-            if (opIt->argCount == sizeof(GobLang::ProgramAddressType))
+            if (opIt->isJump)
             {
+                for (int32_t i = 0; i < opIt->argCount - (int32_t)sizeof(GobLang::ProgramAddressType); i++)
+                {
+                    it++;
+                    address += 1;
+                    std::cout << std::to_string(*it) << " ";
+                }
                 size_t reconAddr = 0x0;
                 for (int32_t i = 0; i < sizeof(GobLang::ProgramAddressType); i++)
                 {
@@ -52,7 +58,7 @@ void byteCodeToText(std::vector<uint8_t> const &bytecode)
                 {
                     it++;
                     address += 1;
-                    std::cout << std::to_string(*it);
+                    std::cout << std::to_string(*it) << " ";
                 }
             }
             address++;
@@ -67,6 +73,11 @@ int main(int argc, char **argv)
     std::vector<std::string> HelpArgs = {"-h", "--help"};
     std::vector<std::string> FileArgs = {"-i", "--input"};
     std::vector<std::string> DecompArgs = {"-s", "--showbytes"};
+    std::vector<std::string> RegisterArgs = {"-r", "--registers"};
+    std::vector<std::string> NoJitArgs = {"--no-jit"};
+    std::vector<std::string> TracingGcArgs = {"--tracing-gc"};
+    std::vector<std::string> RegionGcArgs = {"--region-gc"};
+    std::vector<std::string> GcBudgetArgs = {"--gc-budget"};
     std::vector<std::string> args;
     for (int i = 0; i < argc; i++)
     {
@@ -88,6 +99,11 @@ int main(int argc, char **argv)
         std::cout << "-h | --help       : View help about the interpreter" << std::endl;
         std::cout << "-i | --input      : Run code from file in a given location" << std::endl;
         std::cout << "-s | --showbytes  : Show bytecode before running code" << std::endl;
+        std::cout << "-r | --registers  : Compile into register based bytecode instead of stack based" << std::endl;
+        std::cout << "--no-jit          : Don't compile hot loops into native code" << std::endl;
+        std::cout << "--tracing-gc      : Find unused objects by marking reachable ones instead of reference counting" << std::endl;
+        std::cout << "--gc-budget       : Maximum amount of objects deleted by a single garbage collection" << std::endl;
+        std::cout << "--region-gc       : Don't delete any objects until the program ends and then release them all at once" << std::endl;
         return EXIT_SUCCESS;
     }
 
@@ -104,6 +120,18 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
     std::string file = *(verIt + 1);
+
+    size_t gcBudget = 0;
+    verIt = std::find_first_of(args.begin(), args.end(), GcBudgetArgs.begin(), GcBudgetArgs.end());
+    if (verIt != args.end())
+    {
+        if (verIt + 1 == args.end() || (verIt + 1)->empty() || !std::all_of((verIt + 1)->begin(), (verIt + 1)->end(), ::isdigit))
+        {
+            std::cerr << "Missing budget after garbage collector budget flag" << std::endl;
+            return EXIT_FAILURE;
+        }
+        gcBudget = std::stoul(*(verIt + 1));
+    }
     std::vector<std::string> lines;
     std::ifstream codeFile(file);
     if (!codeFile.is_open())
@@ -123,7 +151,10 @@ int main(int argc, char **argv)
         comp.parse();
         GobLang::Compiler::Validator validator(comp);
         validator.validate();
-        GobLang::Compiler::Compiler compiler(comp);
+        bool registerBased = std::find_first_of(args.begin(), args.end(), RegisterArgs.begin(), RegisterArgs.end()) != args.end();
+        GobLang::NativeRegistry natives;
+        MachineFunctions::addStandardFunctions(natives);
+        GobLang::Compiler::Compiler compiler(comp, registerBased, &natives);
         compiler.compile();
         compiler.generateByteCode();
         verIt = std::find_first_of(args.begin(), args.end(), DecompArgs.begin(), DecompArgs.end());
@@ -131,27 +162,19 @@ int main(int argc, char **argv)
         {
             byteCodeToText(compiler.getByteCode().operations);
         }
-        GobLang::Machine machine(compiler.getByteCode());
-        machine.addFunction(MachineFunctions::getSizeof, "sizeof");
-        machine.addFunction(MachineFunctions::printLine, "print_line");
-        machine.addFunction(MachineFunctions::print, "print");
-        machine.addFunction(MachineFunctions::createArrayOfSize, "array");
-        machine.addFunction(MachineFunctions::input, "input");
-        machine.addFunction(MachineFunctions::Math::toInt, "to_int");
-        machine.addFunction(MachineFunctions::Math::randomIntInRange, "rand_range");
-        machine.addFunction(MachineFunctions::Math::randomInt, "rand");
-        std::vector<size_t> debugPoints = {};
-        while (!machine.isAtTheEnd())
+        GobLang::GarbageCollectorMode gcMode = GobLang::GarbageCollectorMode::ReferenceCounting;
+        if (std::find_first_of(args.begin(), args.end(), TracingGcArgs.begin(), TracingGcArgs.end()) != args.end())
         {
-            if (std::find(debugPoints.begin(), debugPoints.end(), machine.getProgramCounter()) != debugPoints.end())
-            {
-                std::cout << "Debugging at " << std::hex << machine.getProgramCounter() << std::dec << std::endl;
-                machine.printGlobalsInfo();
-                machine.printVariablesInfo();
-                machine.printStack();
-            }
-            machine.step();
+            gcMode = GobLang::GarbageCollectorMode::Tracing;
+        }
+        else if (std::find_first_of(args.begin(), args.end(), RegionGcArgs.begin(), RegionGcArgs.end()) != args.end())
+        {
+            gcMode = GobLang::GarbageCollectorMode::Region;
         }
+        GobLang::Machine machine(compiler.getByteCode(), natives, gcMode);
+        machine.setGarbageCollectorBudget(gcBudget);
+        machine.setJitEnabled(std::find_first_of(args.begin(), args.end(), NoJitArgs.begin(), NoJitArgs.end()) == args.end());
+        machine.run();
     }
     catch (GobLang::Compiler::ParsingError e)
     {
@@ -2,88 +2,89 @@
 #include "../execution/Array.hpp"
 #include "../execution/Memory.hpp"
 #include <random>
-void MachineFunctions::printLine(GobLang::Machine *machine)
+void MachineFunctions::addStandardFunctions(GobLang::NativeRegistry &natives)
+{
+    natives.add("sizeof", getSizeof);
+    natives.add("print_line", printLine);
+    natives.add("print", print);
+    natives.add("array", createArrayOfSize);
+    natives.add("input", input);
+    natives.add("to_int", Math::toInt);
+    natives.add("rand_range", Math::randomIntInRange);
+    natives.add("rand", Math::randomInt);
+}
 
+void MachineFunctions::printLine(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
-    GobLang::MemoryValue *v = machine->getStackTopAndPop();
-    if (v == nullptr)
+    if (!args.empty())
     {
-        return;
+        std::cout << GobLang::valueToString(args[0]);
     }
-    std::cout << GobLang::valueToString(*v) << std::endl;
-    delete v;
+    std::cout << std::endl;
 }
 
-void MachineFunctions::print(GobLang::Machine *machine)
+void MachineFunctions::print(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
-    GobLang::MemoryValue *v = machine->getStackTopAndPop();
-    if (v == nullptr)
+    if (!args.empty())
     {
-        return;
+        std::cout << GobLang::valueToString(args[0]);
     }
-    std::cout << GobLang::valueToString(*v);
-    delete v;
 }
 
-void MachineFunctions::createArrayOfSize(GobLang::Machine *machine)
+void MachineFunctions::createArrayOfSize(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
-    GobLang::MemoryValue *sizeVal = machine->getStackTopAndPop();
-    machine->pushToStack(GobLang::MemoryValue{
-        .type = GobLang::Type::MemoryObj,
-        .value = machine->createArrayOfSize(std::get<int32_t>(sizeVal->value))});
-    delete sizeVal;
+    int32_t size = args.getInt(0);
+    machine->pushToStack(GobLang::MemoryValue::makeObject(machine->createArrayOfSize(size)));
 }
 
-void MachineFunctions::getSizeof(GobLang::Machine *machine)
+void MachineFunctions::getSizeof(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
-    GobLang::MemoryValue *array = machine->getStackTopAndPop();
-    if (array->type != GobLang::Type::MemoryObj)
+    GobLang::MemoryNode *obj = args.getObject(0);
+    switch (obj->getKind())
     {
+    case GobLang::MemoryKind::Array:
+        machine->pushToStack(GobLang::MemoryValue::makeInt((int32_t)static_cast<GobLang::ArrayNode *>(obj)->getSize()));
+        break;
+    case GobLang::MemoryKind::String:
+        machine->pushToStack(GobLang::MemoryValue::makeInt((int32_t)static_cast<GobLang::StringNode *>(obj)->getSize()));
+        break;
+    default:
         throw GobLang::RuntimeException("Attempted to get a size of a non array object");
     }
-    if (GobLang::ArrayNode *arrayNode = dynamic_cast<GobLang::ArrayNode *>(std::get<GobLang::MemoryNode *>(array->value)); arrayNode != nullptr)
-    {
-        machine->pushToStack(GobLang::MemoryValue{.type = GobLang::Type::Int, .value = (int32_t)arrayNode->getSize()});
-    }
-    else if (GobLang::StringNode *strNode = dynamic_cast<GobLang::StringNode *>(std::get<GobLang::MemoryNode *>(array->value)); strNode != nullptr)
-    {
-        machine->pushToStack(GobLang::MemoryValue{.type = GobLang::Type::Int, .value = (int32_t)strNode->getSize()});
-    }
-    delete array;
 }
 
-void MachineFunctions::input(GobLang::Machine *machine)
+void MachineFunctions::input(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
     std::string input;
     getline(std::cin, input);
-    machine->pushToStack(GobLang::MemoryValue{.type = GobLang::Type::MemoryObj, .value = machine->createString(input)});
+    machine->pushToStack(GobLang::MemoryValue::makeObject(machine->createString(input)));
 }
 
-void MachineFunctions::inputChar(GobLang::Machine *machine)
+void MachineFunctions::inputChar(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
     char ch;
     std::cin >> ch;
-    machine->pushToStack(GobLang::MemoryValue{.type = GobLang::Type::Char, .value = ch});
+    machine->pushToStack(GobLang::MemoryValue::makeChar(ch));
 }
 
-void MachineFunctions::Math::toInt(GobLang::Machine *machine)
+void MachineFunctions::Math::toInt(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
     using namespace GobLang;
-    MemoryValue *value = machine->getStackTopAndPop();
-    switch (value->type)
+    MemoryValue const &value = args.get(0);
+    switch (value.getType())
     {
     case Type::Int:
-        machine->pushToStack(*value);
+        machine->pushToStack(value);
         break;
     case GobLang::Type::Number:
-        machine->pushToStack(MemoryValue{.type = Type::Int, .value = (int32_t)std::get<float>(value->value)});
+        machine->pushToStack(MemoryValue::makeInt((int32_t)value.getNumber()));
         break;
     case GobLang::Type::MemoryObj:
         try
         {
-            if (StringNode *node = dynamic_cast<StringNode *>(std::get<MemoryNode *>(value->value)); node != nullptr)
+            if (StringNode *node = memoryCast<StringNode>(value.getObject()); node != nullptr)
             {
-                machine->pushToStack(MemoryValue{.type = Type::Int, .value = std::stoi(node->getString())});
+                machine->pushToStack(MemoryValue::makeInt(std::stoi(node->getString())));
                 break;
             }
         }
@@ -96,43 +97,33 @@ void MachineFunctions::Math::toInt(GobLang::Machine *machine)
             throw RuntimeException(std::string("Unable to convert string to int. ") + e.what());
         }
     default:
-        throw RuntimeException(std::string("Unable to convert type ") + typeToString(value->type) + " to int");
+        throw RuntimeException(std::string("Unable to convert type ") + typeToString(value.getType()) + " to int");
     }
-    delete value;
 }
 
-void MachineFunctions::Math::randomIntInRange(GobLang::Machine *machine)
+void MachineFunctions::Math::randomIntInRange(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
-    GobLang::MemoryValue *max = machine->getStackTopAndPop();
-    GobLang::MemoryValue *min = machine->getStackTopAndPop();
-    if (min->type != GobLang::Type::Int || max->type != GobLang::Type::Int)
-    {
-        throw GobLang::RuntimeException("Random value range values are not type int");
-    }
-    int32_t minVal = std::get<int32_t>(min->value);
-    int32_t maxVal = std::get<int32_t>(max->value);
+    int32_t minVal = args.getInt(0);
+    int32_t maxVal = args.getInt(1);
     if (minVal >= maxVal)
     {
         throw GobLang::RuntimeException(std::string("Invalid random range. Min: " + std::to_string(minVal) + " max: " + std::to_string(maxVal)));
     }
     std::random_device rand_dev;
     std::mt19937 generator(rand_dev());
-    std::uniform_int_distribution<int32_t> distr(std::get<int32_t>(min->value), std::get<int32_t>(max->value));
-    machine->pushToStack(GobLang::MemoryValue{.type = GobLang::Type::Int, .value = distr(generator)});
-
-    delete min;
-    delete max;
+    std::uniform_int_distribution<int32_t> distr(minVal, maxVal);
+    machine->pushToStack(GobLang::MemoryValue::makeInt(distr(generator)));
 }
 
-void MachineFunctions::Math::randomInt(GobLang::Machine *machine)
+void MachineFunctions::Math::randomInt(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
     std::random_device rand_dev;
     std::mt19937 generator(rand_dev());
 
     std::uniform_int_distribution<int32_t> distr(DEFAULT_MIN_RAND_INT, DEFAULT_MAX_RAND_INT);
-    machine->pushToStack(GobLang::MemoryValue{.type = GobLang::Type::Int, .value = distr(generator)});
+    machine->pushToStack(GobLang::MemoryValue::makeInt(distr(generator)));
 }
 
-void MachineFunctions::Math::toFloat(GobLang::Machine *machine)
+void MachineFunctions::Math::toFloat(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
 {
 }
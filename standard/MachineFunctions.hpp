@@ -5,31 +5,38 @@
 
 namespace MachineFunctions
 {
-    void printLine(GobLang::Machine *machine);
+    /**
+     * @brief Add all functions of the standard library that are available to the scripts
+     *
+     * @param natives Registry to add functions to
+     */
+    void addStandardFunctions(GobLang::NativeRegistry &natives);
+
+    void printLine(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
-    void print(GobLang::Machine *machine);
+    void print(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
-    void createArrayOfSize(GobLang::Machine *machine);
+    void createArrayOfSize(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
-    void getSizeof(GobLang::Machine *machine);
+    void getSizeof(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
     /**
      * @brief Read a full line of user input and put it onto the stack
      *
      * @param machine
      */
-    void input(GobLang::Machine *machine);
+    void input(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
-    void inputChar(GobLang::Machine *machine);
+    void inputChar(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
     namespace Math
     {
-        void toInt(GobLang::Machine *machine);
+        void toInt(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
-        void randomIntInRange(GobLang::Machine *machine);
+        void randomIntInRange(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
-        void randomInt(GobLang::Machine *machine);
+        void randomInt(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
 
-        void toFloat(GobLang::Machine *machine);
+        void toFloat(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData);
     }
 }
\ No newline at end of file
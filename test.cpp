@@ -1,8 +1,12 @@
 #include <iostream>
+#include <sstream>
 #include <cassert>
+#include <limits>
 
 #include "compiler/Parser.hpp"
 #include "compiler/Validator.hpp"
+#include "compiler/Compiler.hpp"
+#include "execution/CppTranslator.hpp"
 
 using namespace GobLang::Compiler;
 
@@ -125,6 +129,627 @@ void testUnary()
     Validator::TokenIterator endIt;
     assert(v.unaryExpr(p.getTokens().begin(), endIt));
 }
+/**
+ * @brief Settings used by `compileSource` and `createMachine`
+ *
+ */
+struct SourceOptions
+{
+    bool registers = false;
+    GobLang::NativeRegistry const *natives = nullptr;
+    GobLang::GarbageCollectorMode gcMode = GobLang::GarbageCollectorMode::ReferenceCounting;
+};
+
+/**
+ * @brief Parse, validate and compile the code
+ *
+ */
+ByteCode compileSource(std::string const &code, SourceOptions const &options = SourceOptions())
+{
+    Parser p(code);
+    p.parse();
+    Validator v(p);
+    v.validate();
+    Compiler c(p, options.registers, options.natives);
+    c.compile();
+    c.generateByteCode();
+    return c.getByteCode();
+}
+
+/**
+ * @brief Compile the code and create a machine for it, machine is not started
+ *
+ */
+GobLang::Machine createMachine(std::string const &code, SourceOptions const &options = SourceOptions())
+{
+    return GobLang::Machine(compileSource(code, options), options.natives != nullptr ? *options.natives : GobLang::NativeRegistry(), options.gcMode);
+}
+
+void testFusedLoop()
+{
+    ByteCode code = compileSource("let i = 0; let s = 0; while(i < 10){ s = s + i; i = i + 1; }");
+    std::vector<uint8_t> const &ops = code.operations;
+    assert(std::find(ops.begin(), ops.end(), (uint8_t)GobLang::Operation::IncLocalByConst) != ops.end());
+    assert(std::find(ops.begin(), ops.end(), (uint8_t)GobLang::Operation::JumpIfLocalNotLessConst) != ops.end());
+    GobLang::Machine m(code);
+    m.run();
+    assert(m.getLocalVariableValue(0)->getInt() == 10);
+    assert(m.getLocalVariableValue(1)->getInt() == 45);
+}
+
+void testThreadedRun()
+{
+    // threaded dispatch in `run` has to leave the machine in the same state as executing operations one by one
+    ByteCode code = compileSource("let i = 0; let s = 0; let c = 'a'; while(i < 20){ if(i < 10){ s = s + i; } let j = 0; while(j < 3){ s = s + j; j = j + 1; } i = i + 1; }");
+    GobLang::Machine threaded(code);
+    threaded.setJitEnabled(false);
+    threaded.run();
+    GobLang::Machine stepped(code);
+    stepped.setJitEnabled(false);
+    while (!stepped.isAtTheEnd())
+    {
+        stepped.step();
+    }
+    for (size_t i = 0; i < 3; i++)
+    {
+        assert(threaded.getLocalVariableValue(i)->getType() == stepped.getLocalVariableValue(i)->getType());
+    }
+    assert(threaded.getLocalVariableValue(0)->getInt() == 20);
+    assert(stepped.getLocalVariableValue(0)->getInt() == 20);
+    assert(threaded.getLocalVariableValue(1)->getInt() == 105);
+    assert(stepped.getLocalVariableValue(1)->getInt() == 105);
+    assert(threaded.getLocalVariableValue(2)->getChar() == stepped.getLocalVariableValue(2)->getChar());
+}
+
+void testDecodedJumps()
+{
+    // byte code addresses of the jumps are turned into instruction indices once, when the machine is created
+    ByteCode code = compileSource("let i = 0; let s = 0; while(i < 10){ if(i < 5){ s = s + 1; } i = i + 1; }");
+    std::vector<size_t> starts;
+    for (size_t pc = 0; pc < code.operations.size(); pc += 1 + GobLang::getOperationData((GobLang::Operation)code.operations[pc])->argCount)
+    {
+        starts.push_back(pc);
+    }
+    GobLang::Machine m(code);
+    std::vector<GobLang::Instruction> const &instructions = m.getInstructions();
+    assert(instructions.size() >= starts.size());
+    size_t jumps = 0;
+    for (size_t i = 0; i < starts.size(); i++)
+    {
+        GobLang::OperationData const *opData = GobLang::getOperationData(instructions[i].op);
+        if (!opData->isJump)
+        {
+            continue;
+        }
+        jumps++;
+        size_t addressStart = starts[i] + 1 + opData->argCount - sizeof(GobLang::ProgramAddressType);
+        GobLang::ProgramAddressType address = 0;
+        for (size_t j = 0; j < sizeof(GobLang::ProgramAddressType); j++)
+        {
+            address = (address << 8) | code.operations[addressStart + j];
+        }
+        assert(instructions[i].target < instructions.size());
+        if (address < code.operations.size())
+        {
+            assert(starts[instructions[i].target] == address);
+        }
+        else
+        {
+            assert(instructions[instructions[i].target].op == GobLang::Operation::End);
+        }
+    }
+    assert(jumps >= 2);
+    m.setJitEnabled(false);
+    m.run();
+    assert(m.getLocalVariableValue(0)->getInt() == 10);
+    assert(m.getLocalVariableValue(1)->getInt() == 5);
+}
+
+void testRegisterCode()
+{
+    ByteCode code = compileSource("let i = 0; let s = 0; while(i < 10){ s = s + i; i = i + 1; }", {.registers = true});
+    assert(code.localCount == 2);
+    assert(code.registerCount > code.localCount);
+    GobLang::Machine m(code);
+    m.run();
+    assert(m.getLocalVariableValue(0)->getInt() == 10);
+    assert(m.getLocalVariableValue(1)->getInt() == 45);
+}
+
+void testJitLoop()
+{
+    ByteCode code = compileSource("let i = 0; let s = 0; while(i < 1000){ let j = 0; while(j < 10){ s = s + j; j = j + 1; } i = i + 1; }");
+    GobLang::Machine jit(code);
+    jit.run();
+    GobLang::Machine interp(code);
+    interp.setJitEnabled(false);
+    interp.run();
+#ifdef GOB_JIT_AVAILABLE
+    assert(jit.getCompiledLoopCount() > 0);
+#endif
+    assert(interp.getCompiledLoopCount() == 0);
+    for (size_t i = 0; i < 2; i++)
+    {
+        assert(jit.getLocalVariableValue(i)->getType() == GobLang::Type::Int);
+        assert(jit.getLocalVariableValue(i)->getInt() == interp.getLocalVariableValue(i)->getInt());
+    }
+    assert(jit.getLocalVariableValue(1)->getInt() == 45000);
+}
+
+void testQuickeningDeopt()
+{
+    // same comparison first sees characters and then integers, so quickened operation has to fall back to the generic one
+    GobLang::Machine m = createMachine("let i = 0; let c = 0; let x = 'a'; let y = 'a'; while(i < 4){ if(x == y){ c = c + 1; } x = i; y = i; i = i + 1; }");
+    m.setJitEnabled(false);
+    m.run();
+    assert(m.getLocalVariableValue(0)->getInt() == 4);
+    assert(m.getLocalVariableValue(1)->getInt() == 4);
+}
+
+void testRunBudget()
+{
+    ByteCode code = compileSource("let i = 0; let s = 0; while(i < 1000){ let j = 0; while(j < 10){ s = s + j; j = j + 1; } i = i + 1; }");
+    for (bool jit : {true, false})
+    {
+        GobLang::Machine m(code);
+        m.setJitEnabled(jit);
+        size_t slices = 0;
+        GobLang::RunStatus status;
+        while ((status = m.run(500)) == GobLang::RunStatus::BudgetExhausted)
+        {
+            slices++;
+        }
+        assert(status == GobLang::RunStatus::Finished);
+        assert(slices > 10);
+        assert(m.getLocalVariableValue(1)->getInt() == 45000);
+    }
+}
+
+void testRunError()
+{
+    GobLang::Machine m = createMachine("let i = 0; let s = missing;");
+    assert(m.run(100) == GobLang::RunStatus::Error);
+    assert(!m.getErrorMessage().empty());
+    assert(m.run(100) == GobLang::RunStatus::Error);
+}
+
+bool isRejectedByVerifier(GobLang::Machine &m)
+{
+    try
+    {
+        m.run();
+    }
+    catch (GobLang::RuntimeException const &)
+    {
+        return true;
+    }
+    return false;
+}
+
+void testVerifier()
+{
+    GobLang::Machine underflow;
+    underflow.addOperation(GobLang::Operation::Add);
+    underflow.addOperation(GobLang::Operation::End);
+    assert(isRejectedByVerifier(underflow));
+
+    // condition is false so the jump is taken with empty stack, while falling through leaves one value on the stack
+    GobLang::Machine unbalanced;
+    unbalanced.addOperation(GobLang::Operation::PushFalse);
+    unbalanced.addOperation(GobLang::Operation::JumpIfNot);
+    for (size_t i = 0; i < sizeof(GobLang::ProgramAddressType); i++)
+    {
+        unbalanced.addUInt8(i == sizeof(GobLang::ProgramAddressType) - 1 ? 11 : 0);
+    }
+    unbalanced.addOperation(GobLang::Operation::PushTrue);
+    unbalanced.addOperation(GobLang::Operation::End);
+    assert(isRejectedByVerifier(unbalanced));
+
+    GobLang::Machine missingConst;
+    missingConst.addOperation(GobLang::Operation::PushConstString);
+    missingConst.addUInt8(3);
+    missingConst.addOperation(GobLang::Operation::Pop);
+    assert(missingConst.run(100) == GobLang::RunStatus::Error);
+}
+
+void testCppTranslation()
+{
+    GobLang::CppTranslator translator(compileSource("g = \"a\tb\"; let i = 0; while(i < 10){ i = i + 1; }"));
+    std::stringstream out;
+    translator.translate(out);
+    std::string code = out.str();
+    assert(code.find("void runTranslatedProgram(GobLang::Machine &machine)") != std::string::npos);
+    assert(code.find("goto L") != std::string::npos);
+    // name of the global is passed directly instead of creating a string object for it
+    assert(code.find("machine.setGlobal(\"g\", s1);") != std::string::npos);
+    assert(code.find("machine.createString(\"a\\tb\", true)") != std::string::npos);
+}
+
+void addToCounter(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
+{
+    *static_cast<int32_t *>(userData) += args.getInt(0);
+}
+
+void testNativeCall()
+{
+    int32_t counter = 0;
+    GobLang::NativeRegistry natives;
+    natives.add("add", addToCounter, &counter);
+    for (bool registers : {false, true})
+    {
+        ByteCode code = compileSource("let i = 0; while(i < 10){ add(i); i = i + 1; }", {.registers = registers, .natives = &natives});
+        assert(code.natives.size() == 1);
+        counter = 0;
+        GobLang::Machine m(code, natives);
+        m.run();
+        assert(counter == 45);
+
+        // name is bound when the machine is created, so missing function is only reported once it is called
+        GobLang::Machine missing(code);
+        assert(missing.run(1000) == GobLang::RunStatus::Error);
+        assert(missing.getErrorMessage().find("'add'") != std::string::npos);
+    }
+
+    // arguments are checked by the typed getters
+    for (const char *code : {"let x = add('c');", "let x = add();"})
+    {
+        GobLang::Machine m = createMachine(code, {.natives = &natives});
+        assert(m.run(1000) == GobLang::RunStatus::Error);
+        assert(m.getErrorMessage().find("function 'add'") != std::string::npos);
+    }
+}
+
+void sumOfThree(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
+{
+    machine->pushToStack(GobLang::MemoryValue::makeInt(args.getInt(0) + args.getInt(1) + args.getInt(2)));
+}
+
+void testStackAcrossCalls()
+{
+    // `s` stays on the stack under the call, so cached top of the stack has to be spilled and reloaded around it
+    std::string code = "let i = 0; let s = 0; while(i < 50){ s = s + sum3(i, s - s, 1 + 1); if(s > 100){ s = s - 100; } i = i + 1; }";
+    GobLang::NativeRegistry natives;
+    natives.add("sum3", sumOfThree);
+    for (bool registers : {false, true})
+    {
+        for (size_t budget : {0, 1, 7, 100})
+        {
+            GobLang::Machine m = createMachine(code, {.registers = registers, .natives = &natives});
+            m.setJitEnabled(false);
+            if (budget == 0)
+            {
+                m.run();
+            }
+            else
+            {
+                size_t slices = 0;
+                GobLang::RunStatus status;
+                while ((status = m.run(budget)) == GobLang::RunStatus::BudgetExhausted)
+                {
+                    slices++;
+                }
+                assert(status == GobLang::RunStatus::Finished);
+                assert(slices > 0);
+            }
+            assert(m.getLocalVariableValue(0)->getInt() == 50);
+            assert(m.getLocalVariableValue(1)->getInt() == 25);
+            assert(m.getStackTop() == nullptr);
+        }
+    }
+}
+
+void testValueLayout()
+{
+    using GobLang::MemoryValue;
+    using GobLang::Type;
+    // values must survive the round trip no matter which layout was selected at build time
+    assert(MemoryValue().getType() == Type::Null);
+    assert(MemoryValue::makeInt(-7).getType() == Type::Int);
+    assert(MemoryValue::makeInt(-7).getInt() == -7);
+    assert(MemoryValue::makeChar(-3).getChar() == -3);
+    assert(MemoryValue::makeBool(true).getBool());
+    assert(!MemoryValue::makeBool(false).getBool());
+    assert(MemoryValue::makeNumber(-1.5f).getType() == Type::Number);
+    assert(MemoryValue::makeNumber(-1.5f).getNumber() == -1.5f);
+    MemoryValue nan = MemoryValue::makeNumber(-std::numeric_limits<float>::quiet_NaN());
+    assert(nan.getType() == Type::Number && nan.getNumber() != nan.getNumber());
+    int local = 0;
+    assert(MemoryValue::makeUserData(&local).getUserData() == &local);
+    assert(MemoryValue::makeNativeFunction(12).getType() == Type::NativeFunction);
+    assert(MemoryValue::makeNativeFunction(12).getNativeFunction() == 12);
+}
+
+void testMemoryKind()
+{
+    GobLang::StringNode str("abc");
+    GobLang::StringNode sameStr("abc");
+    std::vector<GobLang::MemoryValue> block(GobLang::ArrayNode::getAllocationSize(2) / sizeof(GobLang::MemoryValue));
+    GobLang::ArrayNode *arr = GobLang::ArrayNode::create(block.data(), 2);
+    GobLang::MemoryNode obj;
+    assert(str.getKind() == GobLang::MemoryKind::String);
+    assert(arr->getKind() == GobLang::MemoryKind::Array);
+    assert(obj.getKind() == GobLang::MemoryKind::Object);
+    assert(GobLang::memoryCast<GobLang::StringNode>(&str) == &str);
+    assert(GobLang::memoryCast<GobLang::ArrayNode>(&str) == nullptr);
+    assert(GobLang::memoryCast<GobLang::ArrayNode>(arr) == arr);
+    assert(GobLang::memoryCast<GobLang::StringNode>(nullptr) == nullptr);
+    assert(str.equalsTo(&sameStr));
+    assert(!str.equalsTo(arr));
+    assert(obj.equalsTo(&obj) && !obj.equalsTo(&str));
+    // items are stored right after the node
+    assert(arr->getSize() == 2 && arr->getItem(1)->getType() == GobLang::Type::Null);
+    arr->~ArrayNode();
+}
+
+void testMemoryList()
+{
+    GobLang::MemoryList list;
+    GobLang::StringNode a("a"), b("b"), c("c");
+    list.pushBack(&a);
+    list.pushBack(&b);
+    list.pushBack(&c);
+    assert(list.getSize() == 3 && list.getFirst() == &a && list.getLast() == &c);
+    list.erase(&b);
+    assert(a.getNext() == &c && c.getPrev() == &a);
+    list.erase(&a);
+    list.erase(&c);
+    assert(list.empty() && list.getFirst() == nullptr && list.getLast() == nullptr);
+
+    GobLang::Machine m = createMachine("let i = 0; while(i < 100){ s = \"s\"; i = i + 1; }");
+    m.run();
+    m.collectGarbage();
+    // only the string stored in the global variable is still referenced
+    assert(m.getObjectCount() == 1);
+}
+
+void testDeferredCollection()
+{
+    for (bool registers : {false, true})
+    {
+        GobLang::Machine m = createMachine("let i = 0; while(i < 1000){ s = \"s\"; i = i + 1; }", {.registers = registers});
+        m.run();
+        // garbage is collected in batches, so it never piles up but isn't freed after every store either
+        assert(m.getObjectCount() > 1);
+        assert(m.getObjectCount() <= 2 * GC_ZERO_COUNT_THRESHOLD + 1);
+        m.collectGarbage();
+        assert(m.getObjectCount() == 1);
+        assert(m.getVariableValue("s").getObject()->toString() == "s");
+    }
+}
+
+void testCreatedVariable()
+{
+    for (GobLang::GarbageCollectorMode mode : {GobLang::GarbageCollectorMode::ReferenceCounting, GobLang::GarbageCollectorMode::Tracing})
+    {
+        for (bool registers : {false, true})
+        {
+            GobLang::Machine m = createMachine("let i = 0; let x = 0; while(i < 1000){ s = \"s\"; x = g[0]; i = i + 1; }", {.registers = registers, .gcMode = mode});
+            GobLang::ArrayNode *arr = m.createArrayOfSize(1);
+            arr->setItem(0, GobLang::MemoryValue::makeInt(7));
+            m.createVariable("g", GobLang::MemoryValue::makeObject(arr));
+            m.createVariable("t", GobLang::MemoryValue::makeObject(m.createString("held")));
+            m.run();
+            m.collectGarbage();
+            // globals created by the native code keep their objects alive like the ones assigned by the program
+            assert(m.getLocalVariableValue(1)->getInt() == 7);
+            assert(m.getVariableValue("g").getObject() == arr);
+            assert(arr->getItem(0)->getInt() == 7);
+            assert(m.getVariableValue("t").getObject()->toString() == "held");
+        }
+    }
+}
+
+void makeArray(GobLang::Machine *machine, GobLang::NativeArguments const &args, void *userData)
+{
+    machine->pushToStack(GobLang::MemoryValue::makeObject(machine->createArrayOfSize(args.getInt(0))));
+}
+
+void testCycleCollection()
+{
+    std::string code = "let c = make_array(1); let d = make_array(1); c[0] = d; d[0] = c;"
+                       "let i = 0; while(i < 100){ let a = make_array(1); let b = make_array(1); a[0] = b; b[0] = a; i = i + 1; }";
+    GobLang::NativeRegistry natives;
+    natives.add("make_array", makeArray);
+    for (bool registers : {false, true})
+    {
+        GobLang::Machine m = createMachine(code, {.registers = registers, .natives = &natives});
+        m.run();
+        m.collectGarbage();
+        // reference counting alone can't free arrays that reference each other
+        assert(m.getObjectCount() == 202);
+        m.collectCycles();
+        // cycle that is still referenced by local variables must survive
+        assert(m.getObjectCount() == 2);
+        assert(m.getGarbageCollectorStats().freedCycleObjects == 200);
+        assert(m.getGarbageCollectorStats().cycleCollections == 1);
+    }
+}
+
+void testTracingCollection()
+{
+    std::string code = "g = make_array(2); g[0] = make_array(1);"
+                       "let c = make_array(1); let d = make_array(1); c[0] = d; d[0] = c;"
+                       "let i = 0; while(i < 100){ let a = make_array(1); let b = make_array(1); a[0] = b; b[0] = a; i = i + 1; }";
+    GobLang::NativeRegistry natives;
+    natives.add("make_array", makeArray);
+    for (bool registers : {false, true})
+    {
+        GobLang::Machine m = createMachine(code, {.registers = registers, .natives = &natives, .gcMode = GobLang::GarbageCollectorMode::Tracing});
+        assert(m.getGarbageCollectorMode() == GobLang::GarbageCollectorMode::Tracing);
+        m.run();
+        // nothing is freed until enough memory is allocated
+        assert(m.getObjectCount() == 204);
+        assert(m.getGarbageCollectorStats().collections == 0);
+        m.collectGarbage();
+        // cycles are freed by marking alone, while everything reachable from globals and locals survives
+        assert(m.getObjectCount() == 4);
+        assert(m.getGarbageCollectorStats().freedObjects == 200);
+        GobLang::ArrayNode *g = GobLang::memoryCast<GobLang::ArrayNode>(m.getGlobal("g").getObject());
+        assert(g != nullptr);
+        assert(g->getItem(0)->getType() == GobLang::Type::MemoryObj);
+        // stores don't touch reference counts in this mode
+        assert(g->getRefCount() == 0);
+    }
+}
+
+void testIncrementalCollection()
+{
+    GobLang::NativeRegistry natives;
+    natives.add("make_array", makeArray);
+    for (GobLang::GarbageCollectorMode mode : {GobLang::GarbageCollectorMode::ReferenceCounting, GobLang::GarbageCollectorMode::Tracing})
+    {
+        for (bool registers : {false, true})
+        {
+            GobLang::Machine m = createMachine("let a = make_array(100); let i = 0; while(i < 100){ a[i] = make_array(1); i = i + 1; } a = 0;",
+                                               {.registers = registers, .natives = &natives, .gcMode = mode});
+            m.setGarbageCollectorBudget(10);
+            m.run();
+            assert(m.getObjectCount() == 101);
+            m.collectGarbage();
+            // dropped array is freed in steps instead of all at once
+            assert(m.getGarbageCollectorStats().freedObjects == 10);
+            assert(m.getObjectCount() == 91);
+            assert(m.isCollectingGarbage());
+            while (m.isCollectingGarbage())
+            {
+                m.collectGarbage();
+            }
+            // register based code keeps the last created array in a temporary register
+            assert(m.getObjectCount() == (registers ? 1 : 0));
+            assert(m.getGarbageCollectorStats().freedObjects == (registers ? 100 : 101));
+        }
+    }
+}
+
+void testNursery()
+{
+    std::string code = "g = \"start\"; let i = 0; while(i < 3000){ let t = \"tmp\"; g = \"value\"; i = i + 1; }"
+                       "let k = 0; while(k < 2){ let s = \"abc\"; if(k == 1){ h = s; } s[0] = 'x'; k = k + 1; }";
+    for (GobLang::GarbageCollectorMode mode : {GobLang::GarbageCollectorMode::ReferenceCounting, GobLang::GarbageCollectorMode::Tracing})
+    {
+        for (bool registers : {false, true})
+        {
+            GobLang::Machine m = createMachine(code, {.registers = registers, .gcMode = mode});
+            m.run();
+            GobLang::GarbageCollectorStats const &stats = m.getGarbageCollectorStats();
+            assert(stats.nurseryCollections > 0);
+            // strings that were stored are copied to the heap, unless nursery was full when they were created
+            assert(stats.promotedObjects >= 5000);
+            m.collectGarbage();
+            assert(m.getObjectCount() < 10);
+            GobLang::StringNode *g = GobLang::memoryCast<GobLang::StringNode>(m.getGlobal("g").getObject());
+            assert(g != nullptr && g->getString() == "value");
+            // every use of the constant creates a new string, while variables that were assigned from each other share it
+            GobLang::StringNode *h = GobLang::memoryCast<GobLang::StringNode>(m.getGlobal("h").getObject());
+            assert(h != nullptr && h->getString() == "xbc");
+        }
+    }
+}
+
+void testRegion()
+{
+    std::string code = "s = \"string that is too long for the small string buffer\"; s[0] = 'S'; n = 5;"
+                       "g = make_array(100); g[0] = make_array(1); let i = 0; while(i < 100){ let a = make_array(1); let b = make_array(1); a[0] = b; b[0] = a; i = i + 1; }";
+    GobLang::NativeRegistry natives;
+    natives.add("make_array", makeArray);
+    for (bool registers : {false, true})
+    {
+        GobLang::Machine m = createMachine(code, {.registers = registers, .natives = &natives, .gcMode = GobLang::GarbageCollectorMode::Region});
+        for (size_t run = 0; run < 2; run++)
+        {
+            m.run();
+            assert(m.isAtTheEnd());
+            // nothing is deleted until the region is released, even by explicit collection
+            m.collectGarbage();
+            m.collectCycles();
+            assert(m.getObjectCount() == 203);
+            assert(m.getGarbageCollectorStats().freedObjects == 0);
+            GobLang::ArrayNode *g = GobLang::memoryCast<GobLang::ArrayNode>(m.getGlobal("g").getObject());
+            assert(g != nullptr && g->getRefCount() == 0);
+            assert(g->getItem(0)->getObject()->getRefCount() == 0);
+            GobLang::StringNode *s = GobLang::memoryCast<GobLang::StringNode>(m.getGlobal("s").getObject());
+            // writing into the literal made a copy, which has to be released together with the region
+            assert(s != nullptr && s->getSize() > 40 && s->getString()[0] == 'S' && !s->isShared());
+            m.reset();
+            // objects are gone, but the program can run again
+            assert(m.getObjectCount() == 0);
+            assert(m.getProgramCounter() == 0 && !m.isAtTheEnd());
+            assert(m.getGlobal("n").getInt() == 5);
+        }
+    }
+}
+
+void testMemoryPool()
+{
+    GobLang::MemoryPool pool;
+    void *a = pool.allocate(24);
+    void *b = pool.allocate(32);
+    assert(a != b);
+    assert(pool.getReservedSize() == MEMORY_POOL_CHUNK_SIZE);
+    pool.free(a, 24);
+    // freed block is reused by the next allocation of the same size class
+    assert(pool.allocate(20) == a);
+    void *big = pool.allocate(GobLang::MemoryPool::MaxBlockSize + 1);
+    pool.free(big, GobLang::MemoryPool::MaxBlockSize + 1);
+    assert(pool.getReservedSize() == MEMORY_POOL_CHUNK_SIZE);
+    pool.free(b, 32);
+
+    GobLang::Machine m;
+    m.createArrayOfSize(1000);
+    m.createString("abc", true);
+    assert(m.getGarbageCollectorStats().freedObjects == 0);
+    m.collectGarbage();
+    assert(m.getGarbageCollectorStats().freedObjects == 2);
+}
+
+void testCopyOnWriteStrings()
+{
+    std::string code = "let k = 0; while(k < 2){ let s = \"abc\"; if(k == 0){ s[0] = 'x'; h = s; } if(k == 1){ g = s; } k = k + 1; }";
+    for (GobLang::GarbageCollectorMode mode : {GobLang::GarbageCollectorMode::ReferenceCounting, GobLang::GarbageCollectorMode::Tracing, GobLang::GarbageCollectorMode::Region})
+    {
+        for (bool registers : {false, true})
+        {
+            GobLang::Machine m = createMachine(code, {.registers = registers, .gcMode = mode});
+            m.run();
+            // written string got its own copy, while the constant and strings created from it later are unchanged
+            GobLang::StringNode *h = GobLang::memoryCast<GobLang::StringNode>(m.getGlobal("h").getObject());
+            assert(h != nullptr && h->getString() == "xbc" && !h->isShared());
+            GobLang::StringNode *g = GobLang::memoryCast<GobLang::StringNode>(m.getGlobal("g").getObject());
+            assert(g != nullptr && g->getString() == "abc" && g->isShared());
+        }
+    }
+    std::string constant = "shared";
+    GobLang::StringNode str(&constant);
+    assert(str.isShared() && str.getSize() == 6 && str.getCharAt(1) == 'h');
+    assert(&str.getString() == &constant);
+}
+
+void testStringIndex()
+{
+    GobLang::Machine m;
+    for (int32_t i = 0; i < 1000; i++)
+    {
+        m.createString("line " + std::to_string(i));
+    }
+    GobLang::StringNode *str = m.createString("line 500");
+    assert(m.getObjectCount() == 1000);
+    assert(m.createString("line 500") == str);
+    // strings that may be written to are never shared
+    GobLang::StringNode *copy = m.createString("line 500", true);
+    assert(copy != str && m.createString("line 500") == str);
+    // string that was written into is no longer found by its old contents
+    m.setArrayItem(GobLang::MemoryValue::makeObject(str), GobLang::MemoryValue::makeInt(0), GobLang::MemoryValue::makeChar('L'));
+    GobLang::StringNode *other = m.createString("line 500");
+    assert(other != str && other != copy);
+    assert(m.createString("line 500") == other && m.createString("Line 500") != str);
+    // deleted strings are removed from the index
+    m.collectGarbage();
+    assert(m.getObjectCount() == 0);
+    GobLang::StringNode *fresh = m.createString("line 1");
+    assert(m.getObjectCount() == 1 && fresh->getString() == "line 1");
+    assert(m.createString("line 1") == fresh);
+}
+
 int main(int, char **)
 {
     testArray();
@@ -139,6 +764,31 @@ int main(int, char **)
     testCallArgs();
     testBlockArray();
     testUnary();
+    testFusedLoop();
+    testThreadedRun();
+    testDecodedJumps();
+    testRegisterCode();
+    testJitLoop();
+    testQuickeningDeopt();
+    testRunBudget();
+    testRunError();
+    testVerifier();
+    testCppTranslation();
+    testNativeCall();
+    testStackAcrossCalls();
+    testValueLayout();
+    testMemoryKind();
+    testMemoryList();
+    testDeferredCollection();
+    testCreatedVariable();
+    testCycleCollection();
+    testTracingCollection();
+    testIncrementalCollection();
+    testNursery();
+    testMemoryPool();
+    testRegion();
+    testCopyOnWriteStrings();
+    testStringIndex();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file